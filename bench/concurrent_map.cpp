@@ -0,0 +1,92 @@
+/**
+ * throughput of concurrent_map for 1, 2, 4 and 8 threads.
+ *
+ * insert: the threads insert n distinct keys between them.
+ * find: the threads look up every key of a map holding n keys.
+ * mixed: on a map holding n / 2 of n keys, each thread does 80% find,
+ *        10% insert and 10% erase on random keys, so nodes are erased
+ *        and reclaimed while others walk.
+ *
+ * build from this directory, next to utility.hpp and exceptions.hpp:
+ *     g++ -std=c++11 -O2 -pthread -I.. concurrent_map.cpp -o concurrent_map
+ *     ./concurrent_map [n]
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "concurrent_map.hpp"
+
+namespace {
+    typedef sjtu::concurrent_map<int, int> map_type;
+    typedef map_type::value_type value_type;
+
+    /// the i-th key, spread over the ints so the inserts are not in order.
+    int keyOf(unsigned i) { return int((i * 2654435761u) >> 1); }
+
+    /// xorshift, one per thread.
+    struct generator {
+        unsigned x;
+        explicit generator(unsigned seed): x(seed * 2654435761u | 1u) {}
+        unsigned operator()() { x ^= x << 13; x ^= x >> 17; x ^= x << 5; return x; }
+    };
+
+    /// run work(t) on threads t = 0 .. threads - 1, return the seconds taken.
+    template<class Work>
+    double timeThreads(int threads, Work work) {
+        std::vector<std::thread> pool;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(int t = 0; t < threads; ++t) pool.emplace_back(work, t);
+        for(size_t t = 0; t < pool.size(); ++t) pool[t].join();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void report(const char *workload, int threads, unsigned ops, double seconds) {
+        std::printf("%-6s %d threads: %8.2f Mops/s\n", workload, threads, ops / seconds / 1e6);
+    }
+
+    void benchInsert(int threads, unsigned n) {
+        map_type m;
+        double seconds = timeThreads(threads, [&](int t) {
+            for(unsigned i = t; i < n; i += threads) m.insert(value_type(keyOf(i), int(i)));
+        });
+        report("insert", threads, n, seconds);
+    }
+    void benchFind(int threads, unsigned n) {
+        map_type m;
+        for(unsigned i = 0; i < n; ++i) m.insert(value_type(keyOf(i), int(i)));
+        std::vector<size_t> hits(threads);
+        double seconds = timeThreads(threads, [&](int t) {
+            for(unsigned i = t; i < n; i += threads) hits[t] += m.count(keyOf(i));
+        });
+        report("find", threads, n, seconds);
+    }
+    void benchMixed(int threads, unsigned n) {
+        map_type m;
+        for(unsigned i = 0; i < n; i += 2) m.insert(value_type(keyOf(i), int(i)));
+        std::vector<size_t> hits(threads);
+        double seconds = timeThreads(threads, [&](int t) {
+            generator gen(t + 1);
+            for(unsigned i = t; i < n; i += threads) {
+                unsigned r = gen();
+                int key = keyOf(r % n);
+                switch(r >> 28) {
+                    case 0: m.insert(value_type(key, int(i))); break;
+                    case 1: m.erase(key); break;
+                    default: hits[t] += m.count(key);
+                }
+            }
+        });
+        report("mixed", threads, n, seconds);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    unsigned n = argc > 1 ? unsigned(std::atoi(argv[1])) : 1000000u;
+    const int threadCounts[] = {1, 2, 4, 8};
+    for(int threads : threadCounts) benchInsert(threads, n);
+    for(int threads : threadCounts) benchFind(threads, n);
+    for(int threads : threadCounts) benchMixed(threads, n);
+    return 0;
+}
@@ -0,0 +1,718 @@
+/**
+ * implement a container like std::map with a B+ tree.
+ *
+ * a node keeps many keys in one array, so a lookup touches a few adjacent
+ * cache lines per level instead of one scattered treap node per level.
+ * values only live in the leaves, which are linked in key order.
+ *
+ * the interface is the same as sjtu::map, but insert and erase move
+ * elements between nodes, so they invalidate all iterators.
+ */
+#ifndef SJTU_BTREE_MAP_HPP
+#define SJTU_BTREE_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+    template<
+    class Key,
+    class T,
+    class Compare = std::less<Key>,
+    class Allocator = std::allocator<pair<const Key, T>>
+    > class btree_map {
+    public:
+        typedef pair<const Key, T> value_type;
+        typedef Allocator allocator_type;
+    private:
+        /// a node holds about nodeBytes of keys, that is four cache lines.
+        static const int nodeBytes = 256;
+        static const int leafCap = sizeof(value_type) * 4 >= nodeBytes ? 4 : int(nodeBytes / sizeof(value_type));
+        static const int innerCap = (sizeof(Key) + sizeof(void *)) * 4 >= nodeBytes ?
+                                    4 : int(nodeBytes / (sizeof(Key) + sizeof(void *)));
+        static const int leafMin = leafCap / 2, innerMin = innerCap / 2;
+        /// the fan-out is at least 3, which bounds the height for any size_t.
+        static const int maxHeight = 64;
+
+        /// count is the number of values in a leaf, or the number of keys in an inner node.
+        struct node {
+            int count;
+        };
+        struct leaf : node {
+            typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type buf[leafCap];
+            leaf *prev, *next;
+
+            value_type *data() { return reinterpret_cast<value_type *>(buf); }
+            const value_type *data() const { return reinterpret_cast<const value_type *>(buf); }
+        };
+        /// every key in child[i] < keys()[i] <= every key in child[i + 1].
+        struct inner : node {
+            typename std::aligned_storage<sizeof(Key), alignof(Key)>::type buf[innerCap];
+            node *child[innerCap + 1];
+
+            Key *keys() { return reinterpret_cast<Key *>(buf); }
+            const Key *keys() const { return reinterpret_cast<const Key *>(buf); }
+        };
+
+        typedef std::allocator_traits<Allocator> alloc_traits;
+        typedef typename alloc_traits::template rebind_alloc<leaf> leaf_allocator;
+        typedef std::allocator_traits<leaf_allocator> leaf_traits;
+        typedef typename alloc_traits::template rebind_alloc<inner> inner_allocator;
+        typedef std::allocator_traits<inner_allocator> inner_traits;
+
+        /// root is a leaf when height is 0, first and last are the ends of the leaf list.
+        node *root;
+        int height;
+        leaf *first, *last;
+        size_t elemSz;
+        Compare cmp;
+        Allocator alloc;
+
+        leaf *newLeaf() {
+            leaf_allocator leafAlloc(alloc);
+            leaf *ptr = leaf_traits::allocate(leafAlloc, 1);
+            ptr->count = 0;
+            ptr->prev = ptr->next = nullptr;
+            return ptr;
+        }
+        inner *newInner() {
+            inner_allocator innerAlloc(alloc);
+            inner *ptr = inner_traits::allocate(innerAlloc, 1);
+            ptr->count = 0;
+            return ptr;
+        }
+        /// the objects inside must have been destroyed.
+        void deleteLeaf(leaf *ptr) {
+            leaf_allocator leafAlloc(alloc);
+            leaf_traits::deallocate(leafAlloc, ptr, 1);
+        }
+        void deleteInner(inner *ptr) {
+            inner_allocator innerAlloc(alloc);
+            inner_traits::deallocate(innerAlloc, ptr, 1);
+        }
+
+        /** move n objects from src to the raw memory dst, the ranges may overlap.
+         * src becomes raw memory. */
+        template<class V>
+        static void moveRange(V *dst, V *src, int n) {
+            if(dst < src) {
+                for(int i = 0; i < n; ++i) {
+                    new (dst + i) V(std::move(src[i]));
+                    src[i].~V();
+                }
+            }
+            else if(dst > src) {
+                for(int i = n - 1; i >= 0; --i) {
+                    new (dst + i) V(std::move(src[i]));
+                    src[i].~V();
+                }
+            }
+        }
+
+        /// index of the child of p where key should be.
+        int childIdx(const inner *p, const Key &key) const {
+            int lo = 0, hi = p->count;
+            while(lo < hi) {
+                int mid = (lo + hi) / 2;
+                if(cmp(key, p->keys()[mid])) hi = mid;
+                else lo = mid + 1;
+            }
+            return lo;
+        }
+        /// index of the first value in p whose key is not less than key.
+        int leafIdx(const leaf *p, const Key &key) const {
+            int lo = 0, hi = p->count;
+            while(lo < hi) {
+                int mid = (lo + hi) / 2;
+                if(cmp(p->data()[mid].first, key)) lo = mid + 1;
+                else hi = mid;
+            }
+            return lo;
+        }
+        /** return the leaf where key should be, the tree must not be empty.
+         * if path is given, the inner nodes and child indices on the way are recorded. */
+        leaf *descend(const Key &key, inner **path = nullptr, int *pidx = nullptr) const {
+            node *p = root;
+            for(int h = 0; h < height; ++h) {
+                inner *in = static_cast<inner *>(p);
+                int c = childIdx(in, key);
+                if(path != nullptr) { path[h] = in; pidx[h] = c; }
+                p = in->child[c];
+            }
+            return static_cast<leaf *>(p);
+        }
+        /// return the leaf holding key and its index in idx, or nullptr.
+        leaf *locate(const Key &key, int &idx) const {
+            if(root == nullptr) return nullptr;
+            leaf *lf = descend(key);
+            idx = leafIdx(lf, key);
+            if(idx < lf->count && !cmp(key, lf->data()[idx].first)) return lf;
+            return nullptr;
+        }
+
+        /// if copying value throws, the values moved aside go back.
+        static void leafInsert(leaf *lf, int pos, const value_type &value) {
+            moveRange(lf->data() + pos + 1, lf->data() + pos, lf->count - pos);
+            try {
+                new (lf->data() + pos) value_type(value);
+            }
+            catch(...) {
+                moveRange(lf->data() + pos, lf->data() + pos + 1, lf->count - pos);
+                throw;
+            }
+            ++lf->count;
+        }
+        /// put key at keys()[c] and right at child[c + 1], p must not be full.
+        static void innerInsert(inner *p, int c, Key &&key, node *right) {
+            moveRange(p->keys() + c + 1, p->keys() + c, p->count - c);
+            new (p->keys() + c) Key(std::move(key));
+            for(int i = p->count + 1; i > c + 1; --i) p->child[i] = p->child[i - 1];
+            p->child[c + 1] = right;
+            ++p->count;
+        }
+        /// drop keys()[k] and child[k + 1].
+        static void innerRemove(inner *p, int k) {
+            p->keys()[k].~Key();
+            moveRange(p->keys() + k, p->keys() + k + 1, p->count - k - 1);
+            for(int i = k + 1; i < p->count; ++i) p->child[i] = p->child[i + 1];
+            --p->count;
+        }
+
+        void linkAfter(leaf *lf, leaf *rt) {
+            rt->prev = lf; rt->next = lf->next;
+            if(lf->next != nullptr) lf->next->prev = rt;
+            lf->next = rt;
+            if(last == lf) last = rt;
+        }
+        /// move the values of rt to the end of lf and delete rt.
+        void mergeLeaf(leaf *lf, leaf *rt) {
+            moveRange(lf->data() + lf->count, rt->data(), rt->count);
+            lf->count += rt->count;
+            lf->next = rt->next;
+            if(rt->next != nullptr) rt->next->prev = lf;
+            if(last == rt) last = lf;
+            deleteLeaf(rt);
+        }
+        /// move sep and the keys and children of rt to the end of lf and delete rt.
+        void mergeInner(inner *lf, inner *rt, const Key &sep) {
+            new (lf->keys() + lf->count) Key(sep);
+            moveRange(lf->keys() + lf->count + 1, rt->keys(), rt->count);
+            for(int i = 0; i <= rt->count; ++i) lf->child[lf->count + 1 + i] = rt->child[i];
+            lf->count += rt->count + 1;
+            deleteInner(rt);
+        }
+
+        /** the inner node path[h] lost a key, borrow from or merge with a
+         * sibling, and go up while the parent underflows too. */
+        void fixInner(inner **path, int *pidx, int h) {
+            for(; h > 0; --h) {
+                inner *p = path[h];
+                if(p->count >= innerMin) return;
+                inner *par = path[h - 1];
+                int c = pidx[h - 1];
+                inner *ls = c > 0 ? static_cast<inner *>(par->child[c - 1]) : nullptr;
+                inner *rs = c < par->count ? static_cast<inner *>(par->child[c + 1]) : nullptr;
+                if(ls != nullptr && ls->count > innerMin) {
+                    /// rotate right: the separator comes down, the last key of ls goes up.
+                    moveRange(p->keys() + 1, p->keys(), p->count);
+                    new (p->keys()) Key(std::move(par->keys()[c - 1]));
+                    par->keys()[c - 1] = std::move(ls->keys()[ls->count - 1]);
+                    ls->keys()[ls->count - 1].~Key();
+                    for(int i = p->count + 1; i > 0; --i) p->child[i] = p->child[i - 1];
+                    p->child[0] = ls->child[ls->count];
+                    ++p->count; --ls->count;
+                    return;
+                }
+                if(rs != nullptr && rs->count > innerMin) {
+                    /// rotate left: the separator comes down, the first key of rs goes up.
+                    new (p->keys() + p->count) Key(std::move(par->keys()[c]));
+                    p->child[p->count + 1] = rs->child[0];
+                    ++p->count;
+                    par->keys()[c] = std::move(rs->keys()[0]);
+                    rs->keys()[0].~Key();
+                    moveRange(rs->keys(), rs->keys() + 1, rs->count - 1);
+                    for(int i = 0; i < rs->count; ++i) rs->child[i] = rs->child[i + 1];
+                    --rs->count;
+                    return;
+                }
+                if(ls != nullptr) { mergeInner(ls, p, par->keys()[c - 1]); innerRemove(par, c - 1); }
+                else { mergeInner(p, rs, par->keys()[c]); innerRemove(par, c); }
+            }
+            /// the root may be left with a single child.
+            inner *top = path[0];
+            if(top->count == 0) {
+                root = top->child[0];
+                deleteInner(top);
+                --height;
+            }
+        }
+
+        /// destroy the subtree p, whose level above the leaves is h.
+        void destroy(node *p, int h) {
+            if(h == 0) {
+                leaf *lf = static_cast<leaf *>(p);
+                for(int i = 0; i < lf->count; ++i) lf->data()[i].~value_type();
+                deleteLeaf(lf);
+                return;
+            }
+            inner *in = static_cast<inner *>(p);
+            for(int i = 0; i <= in->count; ++i) destroy(in->child[i], h - 1);
+            for(int i = 0; i < in->count; ++i) in->keys()[i].~Key();
+            deleteInner(in);
+        }
+        /// copy the subtree p, leaves are appended to the list after last.
+        node *clone(const node *p, int h) {
+            if(h == 0) {
+                const leaf *src = static_cast<const leaf *>(p);
+                leaf *lf = newLeaf();
+                for(int i = 0; i < src->count; ++i) new (lf->data() + i) value_type(src->data()[i]);
+                lf->count = src->count;
+                if(last == nullptr) first = last = lf;
+                else linkAfter(last, lf);
+                return lf;
+            }
+            const inner *src = static_cast<const inner *>(p);
+            inner *in = newInner();
+            for(int i = 0; i < src->count; ++i) new (in->keys() + i) Key(src->keys()[i]);
+            for(int i = 0; i <= src->count; ++i) in->child[i] = clone(src->child[i], h - 1);
+            in->count = src->count;
+            return in;
+        }
+        void cloneFrom(const btree_map &other) {
+            if(other.root != nullptr) root = clone(other.root, other.height);
+            height = other.height;
+            elemSz = other.elemSz;
+        }
+        void swapTree(btree_map &other) {
+            std::swap(root, other.root);
+            std::swap(height, other.height);
+            std::swap(first, other.first);
+            std::swap(last, other.last);
+            std::swap(elemSz, other.elemSz);
+            std::swap(cmp, other.cmp);
+        }
+    public:
+        /**
+         * see BidirectionalIterator at CppReference for help.
+         *
+         * if there is anything wrong throw invalid_iterator.
+         *     like it = map.begin(); --it;
+         *       or it = map.end(); ++end();
+         *
+         * the past-the-end iterator has no leaf.
+         */
+        class const_iterator;
+        class iterator {
+            friend const_iterator;
+            friend btree_map;
+        private:
+            leaf *lf;
+            int idx;
+            const btree_map *owner;
+
+            iterator(leaf *l, int i, const btree_map *o): lf(l), idx(i), owner(o) {}
+        public:
+            iterator(): lf(nullptr), idx(0), owner(nullptr) {}
+            iterator(const iterator &other): lf(other.lf), idx(other.idx), owner(other.owner) {}
+
+            iterator operator++(int) {
+                iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            iterator & operator++() {
+                if(lf == nullptr) throw invalid_iterator();
+                if(++idx == lf->count) { lf = lf->next; idx = 0; }
+                return *this;
+            }
+            iterator operator--(int) {
+                iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+            iterator & operator--() {
+                if(owner == nullptr) throw invalid_iterator();
+                if(lf == nullptr) {
+                    if(owner->last == nullptr) throw invalid_iterator();
+                    lf = owner->last; idx = lf->count - 1;
+                }
+                else if(idx > 0) --idx;
+                else if(lf->prev == nullptr) throw invalid_iterator();
+                else { lf = lf->prev; idx = lf->count - 1; }
+                return *this;
+            }
+            value_type & operator*() const {
+                if(lf == nullptr) throw index_out_of_bound();
+                return lf->data()[idx];
+            }
+            value_type* operator->() const {
+                if(lf == nullptr) throw invalid_iterator();
+                return lf->data() + idx;
+            }
+            bool operator==(const iterator &rhs) const { return lf == rhs.lf && idx == rhs.idx && owner == rhs.owner; }
+            bool operator==(const const_iterator &rhs) const { return lf == rhs.lf && idx == rhs.idx && owner == rhs.owner; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        };
+        class const_iterator {
+            friend iterator;
+            friend btree_map;
+        private:
+            const leaf *lf;
+            int idx;
+            const btree_map *owner;
+
+            const_iterator(const leaf *l, int i, const btree_map *o): lf(l), idx(i), owner(o) {}
+        public:
+            const_iterator(): lf(nullptr), idx(0), owner(nullptr) {}
+            const_iterator(const const_iterator &other): lf(other.lf), idx(other.idx), owner(other.owner) {}
+            const_iterator(const iterator &other): lf(other.lf), idx(other.idx), owner(other.owner) {}
+
+            const_iterator operator++(int) {
+                const_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            const_iterator & operator++() {
+                if(lf == nullptr) throw invalid_iterator();
+                if(++idx == lf->count) { lf = lf->next; idx = 0; }
+                return *this;
+            }
+            const_iterator operator--(int) {
+                const_iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+            const_iterator & operator--() {
+                if(owner == nullptr) throw invalid_iterator();
+                if(lf == nullptr) {
+                    if(owner->last == nullptr) throw invalid_iterator();
+                    lf = owner->last; idx = lf->count - 1;
+                }
+                else if(idx > 0) --idx;
+                else if(lf->prev == nullptr) throw invalid_iterator();
+                else { lf = lf->prev; idx = lf->count - 1; }
+                return *this;
+            }
+            const value_type & operator*() const {
+                if(lf == nullptr) throw index_out_of_bound();
+                return lf->data()[idx];
+            }
+            const value_type* operator->() const {
+                if(lf == nullptr) throw invalid_iterator();
+                return lf->data() + idx;
+            }
+            bool operator==(const iterator &rhs) const { return lf == rhs.lf && idx == rhs.idx && owner == rhs.owner; }
+            bool operator==(const const_iterator &rhs) const { return lf == rhs.lf && idx == rhs.idx && owner == rhs.owner; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        };
+
+        btree_map(): btree_map(Compare()) {}
+        explicit btree_map(const Allocator &a): btree_map(Compare(), a) {}
+        explicit btree_map(const Compare &c, const Allocator &a = Allocator()):
+        root(nullptr), height(0), first(nullptr), last(nullptr), elemSz(0), cmp(c), alloc(a) {}
+        btree_map(const btree_map &other):
+        btree_map(other.cmp, alloc_traits::select_on_container_copy_construction(other.alloc)) {
+            cloneFrom(other);
+        }
+        /// other is left empty.
+        btree_map(btree_map &&other): btree_map(other.cmp, other.alloc) { swap(other); }
+        btree_map & operator=(const btree_map &other) {
+            if(&other == this) return *this;
+            clear();
+            if(alloc_traits::propagate_on_container_copy_assignment::value) alloc = other.alloc;
+            cmp = other.cmp;
+            cloneFrom(other);
+            return *this;
+        }
+        btree_map & operator=(btree_map &&other) {
+            if(&other == this) return *this;
+            clear();
+            if(alloc_traits::propagate_on_container_move_assignment::value || alloc == other.alloc) {
+                swapTree(other);
+                if(alloc_traits::propagate_on_container_move_assignment::value) {
+                    using std::swap;
+                    swap(alloc, other.alloc);
+                }
+            }
+            else {
+                cmp = other.cmp;
+                cloneFrom(other);
+                other.clear();
+            }
+            return *this;
+        }
+        ~btree_map() { clear(); }
+        /**
+         * exchanges the contents with other.
+         * allocators are swapped only if the allocator asks for it.
+         */
+        void swap(btree_map &other) {
+            swapTree(other);
+            if(alloc_traits::propagate_on_container_swap::value) {
+                using std::swap;
+                swap(alloc, other.alloc);
+            }
+        }
+        allocator_type get_allocator() const { return alloc; }
+
+        /**
+         * access specified element with bounds checking
+         * Returns a reference to the mapped value of the element with key equivalent to key.
+         * If no such element exists, an exception of type `index_out_of_bound'
+         */
+        T & at(const Key &key) {
+            int idx;
+            leaf *lf = locate(key, idx);
+            if(lf == nullptr) throw index_out_of_bound();
+            return lf->data()[idx].second;
+        }
+        const T & at(const Key &key) const {
+            int idx;
+            const leaf *lf = locate(key, idx);
+            if(lf == nullptr) throw index_out_of_bound();
+            return lf->data()[idx].second;
+        }
+        /**
+         * access specified element
+         * Returns a reference to the value that is mapped to a key equivalent to key,
+         *   performing an insertion if such key does not already exist.
+         */
+        T & operator[](const Key &key) {
+            int idx;
+            leaf *lf = locate(key, idx);
+            if(lf != nullptr) return lf->data()[idx].second;
+            return insert(value_type(key, T())).first->second;
+        }
+        /**
+         * behave like at() throw index_out_of_bound if such key does not exist.
+         */
+        const T & operator[](const Key &key) const { return at(key); }
+
+        iterator begin() { return iterator(first, 0, this); }
+        const_iterator cbegin() const { return const_iterator(first, 0, this); }
+        iterator end() { return iterator(nullptr, 0, this); }
+        const_iterator cend() const { return const_iterator(nullptr, 0, this); }
+
+        bool empty() const { return elemSz == 0; }
+        size_t size() const { return elemSz; }
+        void clear() {
+            if(root != nullptr) destroy(root, height);
+            root = nullptr;
+            height = 0;
+            first = last = nullptr;
+            elemSz = 0;
+        }
+        /**
+         * insert an element.
+         * return a pair, the first of the pair is
+         *   the iterator to the new element (or the element that prevented the insertion),
+         *   the second one is true if insert successfully, or false.
+         *
+         * a full leaf is split in halves, and the first key of the right half
+         * goes up to the parent, which may split in turn.
+         */
+        pair<iterator, bool> insert(const value_type &value) {
+            if(root == nullptr) {
+                leaf *lf = newLeaf();
+                try {
+                    leafInsert(lf, 0, value);
+                }
+                catch(...) {
+                    deleteLeaf(lf);
+                    throw;
+                }
+                root = first = last = lf;
+                elemSz = 1;
+                return pair<iterator, bool>(iterator(lf, 0, this), true);
+            }
+
+            inner *path[maxHeight];
+            int pidx[maxHeight];
+            leaf *lf = descend(value.first, path, pidx);
+            int pos = leafIdx(lf, value.first);
+            if(pos < lf->count && !cmp(value.first, lf->data()[pos].first))
+                return pair<iterator, bool>(iterator(lf, pos, this), false);
+            if(lf->count < leafCap) {
+                leafInsert(lf, pos, value);
+                ++elemSz;
+                return pair<iterator, bool>(iterator(lf, pos, this), true);
+            }
+
+            /** everything that may throw comes before the tree changes: the copy
+             * of the separator, the new nodes, one per full level on the way up
+             * and a new root if all are full, and the copy of value. after that
+             * only moves. */
+            const int half = leafCap / 2;
+            /// the first key of the right half, whichever side value goes to.
+            Key sep(lf->data()[half].first);
+            int splits = 0;
+            while(splits < height && path[height - 1 - splits]->count == innerCap) ++splits;
+            int spareCnt = splits == height ? splits + 1 : splits;
+            inner *spare[maxHeight + 1];
+            leaf *rt = newLeaf();
+            int made = 0;
+            try {
+                for(; made < spareCnt; ++made) spare[made] = newInner();
+            }
+            catch(...) {
+                while(made > 0) deleteInner(spare[--made]);
+                deleteLeaf(rt);
+                throw;
+            }
+            /// value is copied into the last slot of rt, which the split leaves free.
+            value_type *staged = rt->data() + leafCap - 1;
+            try {
+                new (staged) value_type(value);
+            }
+            catch(...) {
+                for(int i = 0; i < spareCnt; ++i) deleteInner(spare[i]);
+                deleteLeaf(rt);
+                throw;
+            }
+
+            pair<iterator, bool> ret(iterator(), true);
+            if(pos <= half) {
+                moveRange(rt->data(), lf->data() + half, leafCap - half);
+                moveRange(lf->data() + pos + 1, lf->data() + pos, half - pos);
+                moveRange(lf->data() + pos, staged, 1);
+                rt->count = leafCap - half;
+                lf->count = half + 1;
+                ret.first = iterator(lf, pos, this);
+            }
+            else {
+                int before = pos - half;
+                moveRange(rt->data() + before + 1, lf->data() + pos, leafCap - pos);
+                moveRange(rt->data(), lf->data() + half, before);
+                moveRange(rt->data() + before, staged, 1);
+                rt->count = leafCap - half + 1;
+                lf->count = half;
+                ret.first = iterator(rt, before, this);
+            }
+            linkAfter(lf, rt);
+            ++elemSz;
+
+            node *right = rt;
+            int used = 0;
+            for(int h = height - 1; h >= 0; --h) {
+                inner *p = path[h];
+                int c = pidx[h];
+                if(p->count < innerCap) {
+                    innerInsert(p, c, std::move(sep), right);
+                    return ret;
+                }
+                /// keys()[mid] goes up, the keys after it move to a new right sibling.
+                inner *rp = spare[used++];
+                const int mid = innerCap / 2;
+                moveRange(rp->keys(), p->keys() + mid + 1, innerCap - mid - 1);
+                for(int i = mid + 1; i <= innerCap; ++i) rp->child[i - mid - 1] = p->child[i];
+                rp->count = innerCap - mid - 1;
+                Key up(std::move(p->keys()[mid]));
+                p->keys()[mid].~Key();
+                p->count = mid;
+                if(c <= mid) innerInsert(p, c, std::move(sep), right);
+                else innerInsert(rp, c - mid - 1, std::move(sep), right);
+                sep = std::move(up);
+                right = rp;
+            }
+            /// the root is split, the tree grows by one level.
+            inner *top = spare[used];
+            new (top->keys()) Key(std::move(sep));
+            top->child[0] = root; top->child[1] = right;
+            top->count = 1;
+            root = top;
+            ++height;
+            return ret;
+        }
+        /**
+         * erase the element at pos.
+         *
+         * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
+         *
+         * a leaf less than half full borrows from a sibling or merges with it.
+         */
+        void erase(iterator pos) {
+            if(pos.owner != this) throw invalid_iterator();
+            if(pos.lf == nullptr) throw index_out_of_bound();
+
+            inner *path[maxHeight];
+            int pidx[maxHeight];
+            leaf *lf = descend(pos.lf->data()[pos.idx].first, path, pidx);
+            if(lf != pos.lf) throw invalid_iterator();
+
+            lf->data()[pos.idx].~value_type();
+            moveRange(lf->data() + pos.idx, lf->data() + pos.idx + 1, lf->count - pos.idx - 1);
+            --lf->count;
+            --elemSz;
+
+            if(height == 0) {
+                if(lf->count == 0) {
+                    deleteLeaf(lf);
+                    root = nullptr;
+                    first = last = nullptr;
+                }
+                return;
+            }
+            if(lf->count >= leafMin) return;
+
+            inner *par = path[height - 1];
+            int c = pidx[height - 1];
+            leaf *ls = c > 0 ? static_cast<leaf *>(par->child[c - 1]) : nullptr;
+            leaf *rs = c < par->count ? static_cast<leaf *>(par->child[c + 1]) : nullptr;
+            if(ls != nullptr && ls->count > leafMin) {
+                moveRange(lf->data() + 1, lf->data(), lf->count);
+                moveRange(lf->data(), ls->data() + ls->count - 1, 1);
+                ++lf->count; --ls->count;
+                par->keys()[c - 1] = lf->data()[0].first;
+                return;
+            }
+            if(rs != nullptr && rs->count > leafMin) {
+                moveRange(lf->data() + lf->count, rs->data(), 1);
+                moveRange(rs->data(), rs->data() + 1, rs->count - 1);
+                ++lf->count; --rs->count;
+                par->keys()[c] = rs->data()[0].first;
+                return;
+            }
+            if(ls != nullptr) { mergeLeaf(ls, lf); innerRemove(par, c - 1); }
+            else { mergeLeaf(lf, rs); innerRemove(par, c); }
+            fixInner(path, pidx, height - 1);
+        }
+        /**
+         * Returns the number of elements with key
+         *   that compares equivalent to the specified argument,
+         *   which is either 1 or 0
+         *     since this container does not allow duplicates.
+         */
+        size_t count(const Key &key) const {
+            int idx;
+            return locate(key, idx) != nullptr ? 1 : 0;
+        }
+        /**
+         * Finds an element with key equivalent to key.
+         *   If no such element is found, past-the-end (see end()) iterator is returned.
+         */
+        iterator find(const Key &key) {
+            int idx;
+            leaf *lf = locate(key, idx);
+            if(lf == nullptr) return end();
+            return iterator(lf, idx, this);
+        }
+        const_iterator find(const Key &key) const {
+            int idx;
+            const leaf *lf = locate(key, idx);
+            if(lf == nullptr) return cend();
+            return const_iterator(lf, idx, this);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,647 @@
+/**
+ * implement a container like std::map which many threads may use at once.
+ *
+ * it is a lazy skip list: every node has a spinlock, and insert and erase
+ * lock only the predecessors of the node they change. find takes no lock
+ * and never retries, it just walks the links, which are atomic. a node is
+ * erased by first marking it, then unlinking it level by level.
+ *
+ * erased nodes may still be walked by a concurrent find, so they are
+ * freed by epoch based reclamation: every operation pins the current
+ * epoch while it walks, an erased node waits in the limbo list of the
+ * epoch it was erased in, and is freed once the epoch has moved on twice,
+ * when no pinned walk can still reach it. clear(), the destructor and
+ * copying must not run concurrently with anything else.
+ *
+ * iterators and references returned are not pinned by themselves. hold a
+ * guard from pin() while using them if other threads may erase.
+ *
+ * the mapped values are not guarded, threads writing the same value must
+ * synchronize by themselves.
+ */
+#ifndef SJTU_CONCURRENT_MAP_HPP
+#define SJTU_CONCURRENT_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+    template<
+    class Key,
+    class T,
+    class Compare = std::less<Key>,
+    class Allocator = std::allocator<pair<const Key, T>>
+    > class concurrent_map {
+    public:
+        typedef pair<const Key, T> value_type;
+        typedef Allocator allocator_type;
+    private:
+        /// enough for 2^32 elements, a level is kept with probability 1/2.
+        static const int maxLevel = 32;
+
+        /// the links follow the node in the same allocation, next[0 .. topLevel].
+        struct node {
+            typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type data;
+            int topLevel;
+            std::atomic<bool> marked, fullyLinked;
+            std::atomic_flag latch;
+            std::atomic<node *> *next;
+            node *nextRetired;
+
+            void lock() { while(latch.test_and_set(std::memory_order_acquire)) ; }
+            void unlock() { latch.clear(std::memory_order_release); }
+        };
+        typedef std::allocator_traits<Allocator> alloc_traits;
+        typedef typename alloc_traits::template rebind_alloc<node> node_allocator;
+        typedef std::allocator_traits<node_allocator> node_traits;
+
+        static value_type &dataOf(node *p) { return reinterpret_cast<value_type &>(p->data); }
+        static const value_type &dataOf(const node *p) { return reinterpret_cast<const value_type &>(p->data); }
+
+        /// head is a sentinel before every key, the end of the list is nullptr.
+        node *head;
+        std::atomic<size_t> elemSz;
+        /** the levels in use, 1 + the highest topLevel ever inserted, so
+         * walks skip the empty levels of head. it only grows until clear().
+         * a walk that reads an old height starts lower, which is slower but
+         * still right, as every node is on the levels below. */
+        std::atomic<int> height;
+
+        /** pins[i].n[e & 1] counts the threads of stripe i pinned in epoch e,
+         * only two epochs can have pinned threads at once. a stripe fills a
+         * cache line, so threads of different stripes don't contend. */
+        static const int pinStripes = 8;
+        struct pin_counter {
+            std::atomic<size_t> n[2];
+            char pad[64 - 2 * sizeof(std::atomic<size_t>)];
+        };
+        mutable pin_counter pins[pinStripes];
+        std::atomic<size_t> epoch;
+        /// nodes erased in epoch e wait in limbo[e % 3].
+        std::atomic<node *> limbo[3];
+        Compare cmp;
+        Allocator alloc;
+
+        /// the number of node units holding a node with links up to topLevel.
+        static size_t unitsOf(int topLevel) {
+            return 1 + ((topLevel + 1) * sizeof(std::atomic<node *>) + sizeof(node) - 1) / sizeof(node);
+        }
+        /// a node without a value.
+        node *newBare(int topLevel) {
+            node_allocator nodeAlloc(alloc);
+            node *ptr = node_traits::allocate(nodeAlloc, unitsOf(topLevel));
+            ptr->topLevel = topLevel;
+            new (&ptr->marked) std::atomic<bool>(false);
+            new (&ptr->fullyLinked) std::atomic<bool>(false);
+            new (&ptr->latch) std::atomic_flag();
+            ptr->latch.clear();
+            ptr->next = reinterpret_cast<std::atomic<node *> *>(ptr + 1);
+            for(int i = 0; i <= topLevel; ++i) new (ptr->next + i) std::atomic<node *>(nullptr);
+            ptr->nextRetired = nullptr;
+            return ptr;
+        }
+        /// the value must have been destroyed.
+        void deleteBare(node *ptr) {
+            node_allocator nodeAlloc(alloc);
+            node_traits::deallocate(nodeAlloc, ptr, unitsOf(ptr->topLevel));
+        }
+
+        /// a seed for the thread with index i, never 0, where xorshift would stay.
+        static unsigned threadSeed(unsigned i) {
+            unsigned x = i * 2654435761u + 2463534242u;
+            x ^= x >> 16; x *= 0x85ebca6bu;
+            x ^= x >> 13; x *= 0xc2b2ae35u;
+            x ^= x >> 16;
+            return x | 1u;
+        }
+        /// threads are numbered in the order they first get here.
+        static unsigned threadIndex() {
+            static std::atomic<unsigned> threadCount(0);
+            static thread_local unsigned idx = threadCount.fetch_add(1);
+            return idx;
+        }
+        /** each thread draws levels from its own generator, so no state is
+         * shared between threads or maps. */
+        static int randomLevel() {
+            static thread_local unsigned seed = threadSeed(threadIndex());
+            seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+            unsigned bits = seed;
+            int level = 0;
+            while((bits & 1u) && level < maxLevel - 1) { bits >>= 1; ++level; }
+            return level;
+        }
+
+        /// make sure height covers topLevel.
+        void raiseHeight(int topLevel) {
+            int h = height.load(std::memory_order_relaxed);
+            while(h <= topLevel && !height.compare_exchange_weak(h, topLevel + 1, std::memory_order_relaxed)) ;
+        }
+
+        bool before(const node *p, const Key &key) const { return p != nullptr && cmp(dataOf(p).first, key); }
+        bool equals(const node *p, const Key &key) const { return p != nullptr && !cmp(key, dataOf(p).first); }
+
+        /** fill preds and succs with the nodes around key on every level.
+         * return the highest level where succs holds key, or -1.
+         * the levels above height hold head and nullptr, a caller that
+         * links there has raised height first. */
+        int locate(const Key &key, node **preds, node **succs) const {
+            int found = -1;
+            node *pred = head;
+            int top = height.load(std::memory_order_relaxed);
+            for(int level = maxLevel - 1; level >= top; --level) {
+                preds[level] = head;
+                succs[level] = nullptr;
+            }
+            for(int level = top - 1; level >= 0; --level) {
+                node *curr = pred->next[level].load(std::memory_order_acquire);
+                while(before(curr, key)) {
+                    pred = curr;
+                    curr = pred->next[level].load(std::memory_order_acquire);
+                }
+                if(found == -1 && equals(curr, key)) found = level;
+                preds[level] = pred;
+                succs[level] = curr;
+            }
+            return found;
+        }
+        /// the live node with key, or nullptr. no lock, no retry.
+        node *findNode(const Key &key) const {
+            guard g(this);
+            node *pred = head, *curr = nullptr;
+            for(int level = height.load(std::memory_order_relaxed) - 1; level >= 0; --level) {
+                curr = pred->next[level].load(std::memory_order_acquire);
+                while(before(curr, key)) {
+                    pred = curr;
+                    curr = pred->next[level].load(std::memory_order_acquire);
+                }
+                if(equals(curr, key)) break;
+            }
+            if(equals(curr, key) && curr->fullyLinked.load(std::memory_order_acquire)
+               && !curr->marked.load(std::memory_order_acquire))
+                return curr;
+            return nullptr;
+        }
+        /// the last node whose key is before key, or head.
+        node *findPred(const Key &key) const {
+            guard g(this);
+            node *pred = head;
+            for(int level = height.load(std::memory_order_relaxed) - 1; level >= 0; --level) {
+                node *curr = pred->next[level].load(std::memory_order_acquire);
+                while(before(curr, key)) {
+                    pred = curr;
+                    curr = pred->next[level].load(std::memory_order_acquire);
+                }
+            }
+            return pred;
+        }
+        /// unlock the distinct nodes of preds[0 .. highest].
+        static void unlockPreds(node **preds, int highest) {
+            node *prev = nullptr;
+            for(int level = 0; level <= highest; ++level) {
+                if(preds[level] != prev) preds[level]->unlock();
+                prev = preds[level];
+            }
+        }
+
+        /** pin the current epoch for stripe, return its parity.
+         * if the epoch moves on before the pin is counted, pin again, so a
+         * pinned thread is always counted under the epoch it saw. */
+        unsigned enter(unsigned stripe) const {
+            while(true) {
+                size_t e = epoch.load(std::memory_order_seq_cst);
+                pins[stripe].n[e & 1].fetch_add(1, std::memory_order_seq_cst);
+                if(epoch.load(std::memory_order_seq_cst) == e) return unsigned(e & 1);
+                pins[stripe].n[e & 1].fetch_sub(1, std::memory_order_release);
+            }
+        }
+        void leave(unsigned stripe, unsigned parity) const {
+            pins[stripe].n[parity].fetch_sub(1, std::memory_order_release);
+        }
+        /// ptr is unlinked, it waits in the limbo list of the current epoch. the caller is pinned.
+        void retire(node *ptr) {
+            std::atomic<node *> &list = limbo[epoch.load(std::memory_order_seq_cst) % 3];
+            ptr->nextRetired = list.load(std::memory_order_relaxed);
+            while(!list.compare_exchange_weak(ptr->nextRetired, ptr, std::memory_order_release,
+                                              std::memory_order_relaxed)) ;
+        }
+        void freeList(node *ptr) {
+            while(ptr != nullptr) {
+                node *nxt = ptr->nextRetired;
+                dataOf(ptr).~value_type();
+                deleteBare(ptr);
+                ptr = nxt;
+            }
+        }
+        /** move the epoch from e to e + 1 if nobody is pinned in e - 1, then
+         * free the nodes erased in e - 1: every walk that could reach them
+         * was pinned in e - 1 or before, and is over. */
+        void reclaim() {
+            size_t e = epoch.load(std::memory_order_seq_cst);
+            unsigned old = unsigned((e + 1) & 1);
+            for(int i = 0; i < pinStripes; ++i)
+                if(pins[i].n[old].load(std::memory_order_seq_cst) != 0) return;
+            if(!epoch.compare_exchange_strong(e, e + 1, std::memory_order_seq_cst)) return;
+            freeList(limbo[(e + 2) % 3].exchange(nullptr, std::memory_order_acq_rel));
+        }
+
+        /** the node is built before any lock is taken, so an allocator or a
+         * constructor that throws leaves no node locked. the critical
+         * section only stores pointers. */
+        template<class V>
+        pair<node *, bool> insertNode(V &&value) {
+            node *preds[maxLevel], *succs[maxLevel];
+            int topLevel = randomLevel();
+            node *ptr = newBare(topLevel);
+            try {
+                new (&ptr->data) value_type(std::forward<V>(value));
+            }
+            catch(...) {
+                deleteBare(ptr);
+                throw;
+            }
+            const Key &key = dataOf(ptr).first;
+            raiseHeight(topLevel);
+            guard g(this);
+            while(true) {
+                int found = locate(key, preds, succs);
+                if(found != -1) {
+                    node *other = succs[found];
+                    if(!other->marked.load(std::memory_order_acquire)) {
+                        while(!other->fullyLinked.load(std::memory_order_acquire)) ;
+                        dataOf(ptr).~value_type();
+                        deleteBare(ptr);
+                        return pair<node *, bool>(other, false);
+                    }
+                    /// it is being erased, try again after it is gone.
+                    continue;
+                }
+                int highest = -1;
+                bool valid = true;
+                node *prev = nullptr;
+                for(int level = 0; valid && level <= topLevel; ++level) {
+                    node *pred = preds[level], *succ = succs[level];
+                    if(pred != prev) { pred->lock(); highest = level; prev = pred; }
+                    valid = !pred->marked.load(std::memory_order_acquire)
+                            && (succ == nullptr || !succ->marked.load(std::memory_order_acquire))
+                            && pred->next[level].load(std::memory_order_acquire) == succ;
+                }
+                if(!valid) { unlockPreds(preds, highest); continue; }
+
+                for(int level = 0; level <= topLevel; ++level)
+                    ptr->next[level].store(succs[level], std::memory_order_relaxed);
+                for(int level = 0; level <= topLevel; ++level)
+                    preds[level]->next[level].store(ptr, std::memory_order_release);
+                ptr->fullyLinked.store(true, std::memory_order_release);
+                unlockPreds(preds, highest);
+                elemSz.fetch_add(1, std::memory_order_relaxed);
+                return pair<node *, bool>(ptr, true);
+            }
+        }
+        /// erase key; if only is not nullptr, only when key is still in that node.
+        bool eraseNode(const Key &key, const node *only = nullptr) {
+            bool erased;
+            {
+                guard g(this);
+                erased = unlinkNode(key, only);
+            }
+            if(erased) reclaim();
+            return erased;
+        }
+        /// the caller is pinned, the node is retired.
+        bool unlinkNode(const Key &key, const node *only) {
+            node *preds[maxLevel], *succs[maxLevel];
+            node *victim = nullptr;
+            bool isMarked = false;
+            int topLevel = -1;
+            while(true) {
+                int found = locate(key, preds, succs);
+                if(found != -1) victim = succs[found];
+                if(!isMarked) {
+                    /// only a fully linked node found on its top level can be erased.
+                    if(found == -1 || (only != nullptr && victim != only)
+                       || !victim->fullyLinked.load(std::memory_order_acquire)
+                       || victim->topLevel != found || victim->marked.load(std::memory_order_acquire))
+                        return false;
+                    topLevel = victim->topLevel;
+                    victim->lock();
+                    if(victim->marked.load(std::memory_order_relaxed)) {
+                        victim->unlock();
+                        return false;
+                    }
+                    victim->marked.store(true, std::memory_order_release);
+                    isMarked = true;
+                }
+                int highest = -1;
+                bool valid = true;
+                node *prev = nullptr;
+                for(int level = 0; valid && level <= topLevel; ++level) {
+                    node *pred = preds[level];
+                    if(pred != prev) { pred->lock(); highest = level; prev = pred; }
+                    valid = !pred->marked.load(std::memory_order_acquire)
+                            && pred->next[level].load(std::memory_order_acquire) == victim;
+                }
+                if(!valid) { unlockPreds(preds, highest); continue; }
+
+                for(int level = topLevel; level >= 0; --level)
+                    preds[level]->next[level].store(victim->next[level].load(std::memory_order_relaxed),
+                                                    std::memory_order_release);
+                victim->unlock();
+                unlockPreds(preds, highest);
+                elemSz.fetch_sub(1, std::memory_order_relaxed);
+                retire(victim);
+                return true;
+            }
+        }
+        /// free every node but head, nothing may run concurrently.
+        void destroyAll() {
+            for(node *ptr = head->next[0].load(std::memory_order_relaxed); ptr != nullptr; ) {
+                node *nxt = ptr->next[0].load(std::memory_order_relaxed);
+                dataOf(ptr).~value_type();
+                deleteBare(ptr);
+                ptr = nxt;
+            }
+            for(int i = 0; i < 3; ++i) freeList(limbo[i].exchange(nullptr, std::memory_order_relaxed));
+            for(int level = 0; level < maxLevel; ++level) head->next[level].store(nullptr, std::memory_order_relaxed);
+            height.store(1, std::memory_order_relaxed);
+            elemSz.store(0, std::memory_order_relaxed);
+        }
+        void copyFrom(const concurrent_map &other) {
+            /// other is in order, so every node is appended after the last ones.
+            node *last[maxLevel];
+            for(int level = 0; level < maxLevel; ++level) last[level] = head;
+            size_t n = 0;
+            for(const node *src = other.head->next[0].load(std::memory_order_acquire); src != nullptr;
+                src = src->next[0].load(std::memory_order_acquire)) {
+                if(src->marked.load(std::memory_order_acquire)) continue;
+                node *ptr = newBare(randomLevel());
+                new (&ptr->data) value_type(dataOf(src));
+                raiseHeight(ptr->topLevel);
+                for(int level = 0; level <= ptr->topLevel; ++level) {
+                    last[level]->next[level].store(ptr, std::memory_order_relaxed);
+                    last[level] = ptr;
+                }
+                ptr->fullyLinked.store(true, std::memory_order_relaxed);
+                ++n;
+            }
+            elemSz.store(n, std::memory_order_release);
+        }
+    public:
+        /**
+         * a pin on the current epoch. while this thread holds one, no node it
+         * can reach is freed, so iterators and references stay valid even if
+         * other threads erase their elements. hold it briefly: nothing erased
+         * meanwhile in any thread is freed before it is gone.
+         */
+        class guard {
+            friend concurrent_map;
+        private:
+            const concurrent_map *owner;
+            unsigned stripe, parity;
+
+            explicit guard(const concurrent_map *m):
+            owner(m), stripe(threadIndex() % pinStripes), parity(m->enter(stripe)) {}
+        public:
+            guard(guard &&other): owner(other.owner), stripe(other.stripe), parity(other.parity) {
+                other.owner = nullptr;
+            }
+            guard(const guard &) = delete;
+            guard & operator=(const guard &) = delete;
+            ~guard() { if(owner != nullptr) owner->leave(stripe, parity); }
+        };
+        guard pin() const { return guard(this); }
+
+        /**
+         * see BidirectionalIterator at CppReference for help.
+         * ++ follows the bottom links, -- searches for the predecessor in O(log n).
+         * an iterator stays usable after its element is erased while this
+         * thread holds a guard from pin(), see guard.
+         *
+         * if there is anything wrong throw invalid_iterator.
+         *     like it = map.begin(); --it;
+         *       or it = map.end(); ++end();
+         */
+        class const_iterator;
+        class iterator {
+            friend const_iterator;
+            friend concurrent_map;
+        private:
+            node *p;
+            const concurrent_map *owner;
+
+            iterator(node *ptr, const concurrent_map *o): p(ptr), owner(o) {}
+        public:
+            iterator(): p(nullptr), owner(nullptr) {}
+            iterator(const iterator &other): p(other.p), owner(other.owner) {}
+
+            iterator operator++(int) {
+                iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            iterator & operator++() {
+                if(p == nullptr) throw invalid_iterator();
+                p = p->next[0].load(std::memory_order_acquire);
+                return *this;
+            }
+            iterator operator--(int) {
+                iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+            iterator & operator--() {
+                if(owner == nullptr) throw invalid_iterator();
+                node *pred = p == nullptr ? owner->lastNode() : owner->findPred(dataOf(p).first);
+                if(pred == owner->head) throw invalid_iterator();
+                p = pred;
+                return *this;
+            }
+            value_type & operator*() const {
+                if(p == nullptr) throw index_out_of_bound();
+                return dataOf(p);
+            }
+            value_type* operator->() const {
+                if(p == nullptr) throw invalid_iterator();
+                return &dataOf(p);
+            }
+            bool operator==(const iterator &rhs) const { return p == rhs.p && owner == rhs.owner; }
+            bool operator==(const const_iterator &rhs) const { return p == rhs.p && owner == rhs.owner; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        };
+        class const_iterator {
+            friend iterator;
+            friend concurrent_map;
+        private:
+            const node *p;
+            const concurrent_map *owner;
+
+            const_iterator(const node *ptr, const concurrent_map *o): p(ptr), owner(o) {}
+        public:
+            const_iterator(): p(nullptr), owner(nullptr) {}
+            const_iterator(const const_iterator &other): p(other.p), owner(other.owner) {}
+            const_iterator(const iterator &other): p(other.p), owner(other.owner) {}
+
+            const_iterator operator++(int) {
+                const_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            const_iterator & operator++() {
+                if(p == nullptr) throw invalid_iterator();
+                p = p->next[0].load(std::memory_order_acquire);
+                return *this;
+            }
+            const_iterator operator--(int) {
+                const_iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+            const_iterator & operator--() {
+                if(owner == nullptr) throw invalid_iterator();
+                const node *pred = p == nullptr ? owner->lastNode() : owner->findPred(dataOf(p).first);
+                if(pred == owner->head) throw invalid_iterator();
+                p = pred;
+                return *this;
+            }
+            const value_type & operator*() const {
+                if(p == nullptr) throw index_out_of_bound();
+                return dataOf(p);
+            }
+            const value_type* operator->() const {
+                if(p == nullptr) throw invalid_iterator();
+                return &dataOf(p);
+            }
+            bool operator==(const iterator &rhs) const { return p == rhs.p && owner == rhs.owner; }
+            bool operator==(const const_iterator &rhs) const { return p == rhs.p && owner == rhs.owner; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        };
+
+        concurrent_map(): concurrent_map(Compare()) {}
+        explicit concurrent_map(const Allocator &a): concurrent_map(Compare(), a) {}
+        explicit concurrent_map(const Compare &c, const Allocator &a = Allocator()):
+        elemSz(0), height(1), epoch(0), cmp(c), alloc(a) {
+            for(int i = 0; i < pinStripes; ++i) { pins[i].n[0].store(0); pins[i].n[1].store(0); }
+            for(int i = 0; i < 3; ++i) limbo[i].store(nullptr);
+            head = newBare(maxLevel - 1);
+        }
+        concurrent_map(const concurrent_map &other):
+        concurrent_map(other.cmp, alloc_traits::select_on_container_copy_construction(other.alloc)) {
+            copyFrom(other);
+        }
+        concurrent_map & operator=(const concurrent_map &other) {
+            if(&other == this) return *this;
+            clear();
+            cmp = other.cmp;
+            copyFrom(other);
+            return *this;
+        }
+        ~concurrent_map() {
+            destroyAll();
+            deleteBare(head);
+        }
+
+        /**
+         * access specified element with bounds checking
+         * Returns a reference to the mapped value of the element with key equivalent to key.
+         * If no such element exists, an exception of type `index_out_of_bound'
+         */
+        T & at(const Key &key) {
+            node *ptr = findNode(key);
+            if(ptr == nullptr) throw index_out_of_bound();
+            return dataOf(ptr).second;
+        }
+        const T & at(const Key &key) const {
+            const node *ptr = findNode(key);
+            if(ptr == nullptr) throw index_out_of_bound();
+            return dataOf(ptr).second;
+        }
+        /**
+         * access specified element
+         * Returns a reference to the value that is mapped to a key equivalent to key,
+         *   performing an insertion if such key does not already exist.
+         */
+        T & operator[](const Key &key) {
+            node *ptr = findNode(key);
+            if(ptr != nullptr) return dataOf(ptr).second;
+            return dataOf(insertNode(value_type(key, T())).first).second;
+        }
+        /**
+         * behave like at() throw index_out_of_bound if such key does not exist.
+         */
+        const T & operator[](const Key &key) const { return at(key); }
+
+        iterator begin() { return iterator(head->next[0].load(std::memory_order_acquire), this); }
+        const_iterator cbegin() const { return const_iterator(head->next[0].load(std::memory_order_acquire), this); }
+        iterator end() { return iterator(nullptr, this); }
+        const_iterator cend() const { return const_iterator(nullptr, this); }
+
+        bool empty() const { return size() == 0; }
+        size_t size() const { return elemSz.load(std::memory_order_relaxed); }
+        /// must not run concurrently with anything else.
+        void clear() { destroyAll(); }
+        /**
+         * insert an element.
+         * return a pair, the first of the pair is
+         *   the iterator to the new element (or the element that prevented the insertion),
+         *   the second one is true if insert successfully, or false.
+         */
+        pair<iterator, bool> insert(const value_type &value) {
+            pair<node *, bool> res = insertNode(value);
+            return pair<iterator, bool>(iterator(res.first, this), res.second);
+        }
+        /**
+         * erase the element at pos, nothing happens if another thread has erased it.
+         *
+         * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
+         */
+        void erase(iterator pos) {
+            if(pos.owner != this) throw invalid_iterator();
+            if(pos.p == nullptr) throw index_out_of_bound();
+            /// the key may have been erased and inserted again in another node.
+            eraseNode(dataOf(pos.p).first, pos.p);
+        }
+        /**
+         * erase the element with key, return the number of elements erased.
+         */
+        size_t erase(const Key &key) { return eraseNode(key) ? 1 : 0; }
+        /**
+         * Returns the number of elements with key
+         *   that compares equivalent to the specified argument,
+         *   which is either 1 or 0
+         *     since this container does not allow duplicates.
+         */
+        size_t count(const Key &key) const { return findNode(key) != nullptr ? 1 : 0; }
+        /**
+         * Finds an element with key equivalent to key.
+         *   If no such element is found, past-the-end (see end()) iterator is returned.
+         */
+        iterator find(const Key &key) { return iterator(findNode(key), this); }
+        const_iterator find(const Key &key) const { return const_iterator(findNode(key), this); }
+    private:
+        /// the last node of the list, or head.
+        node *lastNode() const {
+            guard g(this);
+            node *pred = head;
+            for(int level = height.load(std::memory_order_relaxed) - 1; level >= 0; --level) {
+                node *curr = pred->next[level].load(std::memory_order_acquire);
+                while(curr != nullptr) {
+                    pred = curr;
+                    curr = pred->next[level].load(std::memory_order_acquire);
+                }
+            }
+            return pred;
+        }
+    };
+}
+
+#endif
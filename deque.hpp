@@ -4,6 +4,8 @@
 #include "exceptions.hpp"
 #include <iostream>
 #include <cstddef>
+#include <memory>
+#include <utility>
 
 /** My deque is implemented by a block linked list.
  * The maintainance of a block linked list is utterly important for
@@ -15,28 +17,32 @@ namespace sjtu {
     
     class pop_empty_block{};
     
-    template<class T>
+    template<class T, class Allocator = std::allocator<T>>
     class deque {
+    public:
+        typedef Allocator allocator_type;
     private:
+        /** A node doesn't own its array, which is allocated and freed by
+         * newNode and deleteNode with the deque's allocator. */
         struct node{
             T *arr;
             size_t allocLen, logicLen;
             node *prev;
             node *next;
             
-            node(size_t alloc, node *prev = nullptr, node *next = nullptr) {
-                arr = (T *)malloc(alloc * sizeof(T));
+            node(T *buf, size_t alloc, node *prev = nullptr, node *next = nullptr) {
+                arr = buf;
                 allocLen = alloc;
                 logicLen = 0;
                 this->prev = prev;
                 this->next = next;
             }
             /** Copy constructor. */
-            node(node *other, node *prev = nullptr, node *next = nullptr):
+            node(T *buf, node *other, node *prev = nullptr, node *next = nullptr):
             prev(prev), next(next) {
                 allocLen = other->allocLen;
                 logicLen = other->logicLen;
-                arr = (T *)malloc(allocLen * sizeof(T));
+                arr = buf;
                 
                 T *tmp;
                 for(int i = 0; i < logicLen; ++i){
@@ -44,19 +50,75 @@ namespace sjtu {
                     new (tmp) T(other->arr[i]);
                 }
             }
-            ~node(){
-                free(arr);
-            }
         };
         
+        typedef std::allocator_traits<Allocator> alloc_traits;
+        typedef typename alloc_traits::template rebind_alloc<node> node_allocator;
+        typedef std::allocator_traits<node_allocator> node_traits;
+        
         node *head, *tail;
         size_t len;
         size_t blockSize;
         size_t blockNum;
         int counter;
+        Allocator alloc;
         
         const static int resizeConstant = 300;
         
+        node *newNode(size_t size, node *prev = nullptr, node *next = nullptr) {
+            node_allocator nodeAlloc(alloc);
+            node *ptr = node_traits::allocate(nodeAlloc, 1);
+            new (ptr) node(alloc_traits::allocate(alloc, size), size, prev, next);
+            return ptr;
+        }
+        node *newNode(node *other, node *prev = nullptr) {
+            node_allocator nodeAlloc(alloc);
+            node *ptr = node_traits::allocate(nodeAlloc, 1);
+            new (ptr) node(alloc_traits::allocate(alloc, other->allocLen), other, prev);
+            return ptr;
+        }
+        /** Elements must have been destroyed. */
+        void deleteNode(node *ptr) {
+            alloc_traits::deallocate(alloc, ptr->arr, ptr->allocLen);
+            ptr->~node();
+            node_allocator nodeAlloc(alloc);
+            node_traits::deallocate(nodeAlloc, ptr, 1);
+        }
+        
+        /** Copy every node of other, this deque must hold nothing. */
+        void copyNodes(const deque &other) {
+            head = newNode(other.head);
+            tail = newNode(other.tail);
+            
+            /** Running copy construct every node.
+             * Everything detail is encapsulated in the copy constructor. */
+            node *thisNode = head, *otherNode = other.head->next;
+            
+            while(otherNode != other.tail){
+                node *curNode = newNode(otherNode, thisNode);
+                thisNode->next = curNode;
+                otherNode = otherNode->next;
+                thisNode = thisNode->next;
+            }
+            thisNode->next = tail;
+            tail->prev = thisNode;
+            
+            /** Update fields. */
+            blockNum = other.blockNum;
+            blockSize = other.blockSize;
+            len = other.len;
+            counter = other.counter;
+        }
+        
+        void swapNodes(deque &other) {
+            std::swap(head, other.head);
+            std::swap(tail, other.tail);
+            std::swap(len, other.len);
+            std::swap(blockSize, other.blockSize);
+            std::swap(blockNum, other.blockNum);
+            std::swap(counter, other.counter);
+        }
+        
         /**
          * This function is a utility for erase public member function.
          * It assures curNode has enough space to hold extra elements in
@@ -82,7 +144,7 @@ namespace sjtu {
             curNode->next->next->prev = curNode;
             curNode->next = curNode->next->next;
             
-            delete del;
+            deleteNode(del);
         }
         
         int mySqrt(size_t n){
@@ -615,50 +677,36 @@ namespace sjtu {
         /**
          * TODO Constructors
          */
-        explicit deque(size_t blockSize = 30) {
-            head = new node(blockSize);
-            tail = new node(blockSize);
-            head->next = new node(blockSize, head, tail);
+        explicit deque(size_t blockSize = 30, const Allocator &a = Allocator()): alloc(a) {
+            head = newNode(blockSize);
+            tail = newNode(blockSize);
+            head->next = newNode(blockSize, head, tail);
             tail->prev = head->next;
             len = 0;
             blockNum = 1;
             this->blockSize = blockSize;
             counter = 0;
         }
+        explicit deque(const Allocator &a): deque(30, a) {}
         
         /** Wait for more member functions.
          * Or maybe I can write a prototype. */
-        deque(const deque &other) {
-            head = new node(other.head);
-            tail = new node(other.tail);
-            
-            /** Running copy construct every node.
-             * Everything detail is encapsulated in the copy constructor. */
-            node *thisNode = head, *otherNode = other.head->next;
-            
-            while(otherNode != other.tail){
-                node *newNode = new node(otherNode, thisNode);
-                thisNode->next = newNode;
-                otherNode = otherNode->next;
-                thisNode = thisNode->next;
-            }
-            thisNode->next = tail;
-            tail->prev = thisNode;
-            
-            /** Update fields. */
-            blockNum = other.blockNum;
-            blockSize = other.blockSize;
-            len = other.len;
-            counter = other.counter;
+        deque(const deque &other):
+        alloc(alloc_traits::select_on_container_copy_construction(other.alloc)) {
+            copyNodes(other);
+        }
+        /** other is left as an empty deque. */
+        deque(deque &&other): deque(other.blockSize, other.alloc) {
+            swap(other);
         }
         /**
          * TODO Deconstructor
          */
         ~deque() {
             clear();
-            delete head->next;
-            delete head;
-            delete tail;
+            deleteNode(head->next);
+            deleteNode(head);
+            deleteNode(tail);
             head = tail = nullptr;
         }
         /**
@@ -668,29 +716,41 @@ namespace sjtu {
             if(this == &other)
                 return *this;
             this->~deque();
-            head = new node(other.head);
-            tail = new node(other.tail);
-            
-            /** Running copy construct every node.
-             * Everything detail is encapsulated in the copy constructor. */
-            node *thisNode = head, *otherNode = other.head->next;
-            
-            while(otherNode != other.tail){
-                node *newNode = new node(otherNode, thisNode);
-                thisNode->next = newNode;
-                otherNode = otherNode->next;
-                thisNode = thisNode->next;
+            if(alloc_traits::propagate_on_container_copy_assignment::value)
+                alloc = other.alloc;
+            copyNodes(other);
+            return *this;
+        }
+        deque &operator=(deque &&other) {
+            if(this == &other)
+                return *this;
+            /** Our nodes can be handed to other only if its allocator can free them. */
+            if(alloc_traits::propagate_on_container_move_assignment::value || alloc == other.alloc){
+                swapNodes(other);
+                if(alloc_traits::propagate_on_container_move_assignment::value){
+                    using std::swap;
+                    swap(alloc, other.alloc);
+                }
             }
-            thisNode->next = tail;
-            tail->prev = thisNode;
-            
-            /** Update fields. */
-            blockNum = other.blockNum;
-            blockSize = other.blockSize;
-            len = other.len;
-            counter = other.counter;
+            else{
+                this->~deque();
+                copyNodes(other);
+            }
+            other.clear();
             return *this;
         }
+        /**
+         * exchanges the contents with other.
+         * allocators are swapped only if the allocator asks for it.
+         */
+        void swap(deque &other) {
+            swapNodes(other);
+            if(alloc_traits::propagate_on_container_swap::value){
+                using std::swap;
+                swap(alloc, other.alloc);
+            }
+        }
+        allocator_type get_allocator() const { return alloc; }
         /**
          * access specified element with bounds checking
          * throw index_out_of_bound if out of bound.
@@ -836,14 +896,14 @@ namespace sjtu {
                  * satisfy requirements. */
                 else {
                     /** Create a new block. */
-                    node *newNode = new node(blockSize, posNode, posNode->next);
-                    posNode->next->prev = newNode;
-                    posNode->next = newNode;
+                    node *curNode = newNode(blockSize, posNode, posNode->next);
+                    posNode->next->prev = curNode;
+                    posNode->next = curNode;
                     /** Add the previous last element to the first. */
-                    T *ptrTmp = &newNode->arr[0];
+                    T *ptrTmp = &curNode->arr[0];
                     new (ptrTmp) T(tmp);
                     /** Update fields. */
-                    ++newNode->logicLen;
+                    ++curNode->logicLen;
                     ++blockNum;
                     ++len;
                 }
@@ -946,12 +1006,12 @@ namespace sjtu {
         void push_back(const T &value, bool resizeFlag = false) {
             /** Create another node. */
             if(tail->prev->logicLen == tail->prev->allocLen){
-                node *newNode = new node(blockSize, tail->prev, tail);
-                tail->prev->next = newNode;
-                tail->prev = newNode;
-                T *tmp = &newNode->arr[0];
+                node *curNode = newNode(blockSize, tail->prev, tail);
+                tail->prev->next = curNode;
+                tail->prev = curNode;
+                T *tmp = &curNode->arr[0];
                 new (tmp) T(value);
-                ++newNode->logicLen;
+                ++curNode->logicLen;
                 ++blockNum;
                 ++len;
             }
@@ -995,7 +1055,7 @@ namespace sjtu {
             if(cur->logicLen == 0 && blockNum != 1){
                 tail->prev->prev->next = tail;
                 tail->prev = tail->prev->prev;
-                delete cur;
+                deleteNode(cur);
                 --blockNum;
             }
             
@@ -1032,14 +1092,14 @@ namespace sjtu {
             }
             else{
                 /** Create an additional node. */
-                node *newNode = new node(blockSize, head, head->next);
-                head->next->prev = newNode;
-                head->next = newNode;
+                node *curNode = newNode(blockSize, head, head->next);
+                head->next->prev = curNode;
+                head->next = curNode;
                 /** Insert the first element. */
-                T *ptrTmp = &newNode->arr[newNode->logicLen];
+                T *ptrTmp = &curNode->arr[curNode->logicLen];
                 new (ptrTmp) T(value);
                 /** Update field. */
-                ++(newNode->logicLen);
+                ++(curNode->logicLen);
                 ++len;
                 ++blockNum;
             }
@@ -1075,7 +1135,7 @@ namespace sjtu {
             if(curNode->logicLen == 0 && blockNum != 1){
                 head->next->next->prev = head;
                 head->next = head->next->next;
-                delete curNode;
+                deleteNode(curNode);
                 --blockNum;
             }
             
@@ -1135,7 +1195,7 @@ namespace sjtu {
                 return;
             
             //std::cout << "resize" << ' ';
-            deque newDq(newBlockSize);
+            deque newDq(newBlockSize, alloc);
             
             iterator itr = begin();
             
@@ -0,0 +1,373 @@
+/**
+ * implement a container like std::map on sorted arrays.
+ *
+ * keys and values are kept in two sjtu::vector, so a lookup is a binary
+ * search over a contiguous array of keys only. it suits maps which are
+ * built once and then read many times: insert and erase of a single
+ * element cost O(n), the bulk insert sorts and merges in one pass.
+ *
+ * insert and erase invalidate all iterators.
+ */
+#ifndef SJTU_FLAT_MAP_HPP
+#define SJTU_FLAT_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "vector.hpp"
+
+namespace sjtu {
+
+    template<
+    class Key,
+    class T,
+    class Compare = std::less<Key>,
+    class Allocator = std::allocator<pair<const Key, T>>
+    > class flat_map {
+    public:
+        typedef pair<const Key, T> value_type;
+        /// keys and values are apart, so an iterator yields a pair of references.
+        typedef pair<const Key &, T &> reference;
+        typedef pair<const Key &, const T &> const_reference;
+        typedef Allocator allocator_type;
+    private:
+        typedef std::allocator_traits<Allocator> alloc_traits;
+        typedef vector<Key, typename alloc_traits::template rebind_alloc<Key>> key_vector;
+        typedef vector<T, typename alloc_traits::template rebind_alloc<T>> value_vector;
+        typedef vector<size_t, typename alloc_traits::template rebind_alloc<size_t>> index_vector;
+
+        /// the branch-free search is used for arithmetic keys in the default order.
+        typedef std::integral_constant<bool,
+            std::is_arithmetic<Key>::value && std::is_same<Compare, std::less<Key>>::value> plainKey;
+
+        key_vector keys;
+        value_vector vals;
+        Compare cmp;
+
+        /**
+         * index of the first key not less than key.
+         * the range shrinks by half without a branch on the comparison,
+         * which the compiler turns into a conditional move.
+         */
+        size_t lowerIdx(const Key &key, std::true_type) const {
+            size_t n = keys.size();
+            if(n == 0) return 0;
+            const Key *base = keys.data();
+            while(n > 1) {
+                size_t half = n / 2;
+                base = base[half] < key ? base + half : base;
+                n -= half;
+            }
+            return (base - keys.data()) + (*base < key);
+        }
+        size_t lowerIdx(const Key &key, std::false_type) const {
+            const Key *base = keys.data();
+            size_t lo = 0, hi = keys.size();
+            while(lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if(cmp(base[mid], key)) lo = mid + 1;
+                else hi = mid;
+            }
+            return lo;
+        }
+        size_t lowerIdx(const Key &key) const { return lowerIdx(key, plainKey()); }
+        /** put key and value at index i. the value goes in first and is
+         * taken out again if the key can't follow, so that keys and vals
+         * never differ in length. */
+        template<class V>
+        void insertAt(size_t i, const Key &key, V &&value) {
+            vals.insert(i, std::forward<V>(value));
+            try {
+                keys.insert(i, key);
+            }
+            catch(...) {
+                vals.erase(i);
+                throw;
+            }
+        }
+        /// index of key, or size() if it is absent.
+        size_t indexOf(const Key &key) const {
+            size_t i = lowerIdx(key);
+            if(i < keys.size() && !cmp(key, keys.data()[i])) return i;
+            return keys.size();
+        }
+    public:
+        /**
+         * see BidirectionalIterator at CppReference for help.
+         *
+         * if there is anything wrong throw invalid_iterator.
+         *     like it = map.begin(); --it;
+         *       or it = map.end(); ++end();
+         */
+        class const_iterator;
+        class iterator {
+            friend const_iterator;
+            friend flat_map;
+        private:
+            size_t pos;
+            flat_map *owner;
+
+            iterator(size_t p, flat_map *o): pos(p), owner(o) {}
+        public:
+            /// operator-> has to return something holding the pair.
+            struct pointer {
+                reference ref;
+                reference *operator->() { return &ref; }
+            };
+
+            iterator(): pos(0), owner(nullptr) {}
+            iterator(const iterator &other): pos(other.pos), owner(other.owner) {}
+
+            iterator operator++(int) {
+                iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            iterator & operator++() {
+                if(owner == nullptr || pos >= owner->size()) throw invalid_iterator();
+                ++pos;
+                return *this;
+            }
+            iterator operator--(int) {
+                iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+            iterator & operator--() {
+                if(owner == nullptr || pos == 0) throw invalid_iterator();
+                --pos;
+                return *this;
+            }
+            reference operator*() const {
+                if(owner == nullptr || pos >= owner->size()) throw index_out_of_bound();
+                return reference(owner->keys.data()[pos], owner->vals.data()[pos]);
+            }
+            pointer operator->() const {
+                if(owner == nullptr || pos >= owner->size()) throw invalid_iterator();
+                return pointer{reference(owner->keys.data()[pos], owner->vals.data()[pos])};
+            }
+            bool operator==(const iterator &rhs) const { return pos == rhs.pos && owner == rhs.owner; }
+            bool operator==(const const_iterator &rhs) const { return pos == rhs.pos && owner == rhs.owner; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        };
+        class const_iterator {
+            friend iterator;
+            friend flat_map;
+        private:
+            size_t pos;
+            const flat_map *owner;
+
+            const_iterator(size_t p, const flat_map *o): pos(p), owner(o) {}
+        public:
+            struct pointer {
+                const_reference ref;
+                const_reference *operator->() { return &ref; }
+            };
+
+            const_iterator(): pos(0), owner(nullptr) {}
+            const_iterator(const const_iterator &other): pos(other.pos), owner(other.owner) {}
+            const_iterator(const iterator &other): pos(other.pos), owner(other.owner) {}
+
+            const_iterator operator++(int) {
+                const_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            const_iterator & operator++() {
+                if(owner == nullptr || pos >= owner->size()) throw invalid_iterator();
+                ++pos;
+                return *this;
+            }
+            const_iterator operator--(int) {
+                const_iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+            const_iterator & operator--() {
+                if(owner == nullptr || pos == 0) throw invalid_iterator();
+                --pos;
+                return *this;
+            }
+            const_reference operator*() const {
+                if(owner == nullptr || pos >= owner->size()) throw index_out_of_bound();
+                return const_reference(owner->keys.data()[pos], owner->vals.data()[pos]);
+            }
+            pointer operator->() const {
+                if(owner == nullptr || pos >= owner->size()) throw invalid_iterator();
+                return pointer{const_reference(owner->keys.data()[pos], owner->vals.data()[pos])};
+            }
+            bool operator==(const iterator &rhs) const { return pos == rhs.pos && owner == rhs.owner; }
+            bool operator==(const const_iterator &rhs) const { return pos == rhs.pos && owner == rhs.owner; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        };
+
+        flat_map(): flat_map(Compare()) {}
+        explicit flat_map(const Allocator &a): flat_map(Compare(), a) {}
+        explicit flat_map(const Compare &c, const Allocator &a = Allocator()):
+        keys(typename key_vector::allocator_type(a)), vals(typename value_vector::allocator_type(a)), cmp(c) {}
+        /// build from any range of pairs, see insert(first, last).
+        template<class InputIt>
+        flat_map(InputIt first, InputIt last, const Compare &c = Compare(), const Allocator &a = Allocator()):
+        flat_map(c, a) {
+            insert(first, last);
+        }
+        flat_map(const flat_map &other) = default;
+        flat_map(flat_map &&other) = default;
+        flat_map & operator=(const flat_map &other) = default;
+        flat_map & operator=(flat_map &&other) = default;
+        ~flat_map() = default;
+        void swap(flat_map &other) {
+            keys.swap(other.keys);
+            vals.swap(other.vals);
+            using std::swap;
+            swap(cmp, other.cmp);
+        }
+        allocator_type get_allocator() const { return allocator_type(keys.get_allocator()); }
+
+        /**
+         * access specified element with bounds checking
+         * Returns a reference to the mapped value of the element with key equivalent to key.
+         * If no such element exists, an exception of type `index_out_of_bound'
+         */
+        T & at(const Key &key) {
+            size_t i = indexOf(key);
+            if(i == keys.size()) throw index_out_of_bound();
+            return vals.data()[i];
+        }
+        const T & at(const Key &key) const {
+            size_t i = indexOf(key);
+            if(i == keys.size()) throw index_out_of_bound();
+            return vals.data()[i];
+        }
+        /**
+         * access specified element
+         * Returns a reference to the value that is mapped to a key equivalent to key,
+         *   performing an insertion if such key does not already exist.
+         */
+        T & operator[](const Key &key) {
+            size_t i = lowerIdx(key);
+            if(i == keys.size() || cmp(key, keys.data()[i])) {
+                insertAt(i, key, T());
+            }
+            return vals.data()[i];
+        }
+        /**
+         * behave like at() throw index_out_of_bound if such key does not exist.
+         */
+        const T & operator[](const Key &key) const { return at(key); }
+
+        iterator begin() { return iterator(0, this); }
+        const_iterator cbegin() const { return const_iterator(0, this); }
+        iterator end() { return iterator(keys.size(), this); }
+        const_iterator cend() const { return const_iterator(keys.size(), this); }
+
+        bool empty() const { return keys.empty(); }
+        size_t size() const { return keys.size(); }
+        void clear() {
+            keys.clear();
+            vals.clear();
+        }
+        void reserve(size_t n) {
+            keys.reserve(n);
+            vals.reserve(n);
+        }
+        /**
+         * insert an element.
+         * return a pair, the first of the pair is
+         *   the iterator to the new element (or the element that prevented the insertion),
+         *   the second one is true if insert successfully, or false.
+         */
+        pair<iterator, bool> insert(const value_type &value) {
+            size_t i = lowerIdx(value.first);
+            if(i < keys.size() && !cmp(value.first, keys.data()[i]))
+                return pair<iterator, bool>(iterator(i, this), false);
+            insertAt(i, value.first, value.second);
+            return pair<iterator, bool>(iterator(i, this), true);
+        }
+        /**
+         * insert every pair in [first, last) whose key is not present yet,
+         * and the first one among equivalent keys in the range.
+         *
+         * the new elements are sorted on their own and then merged with the
+         * old ones in a single pass, O(n + m log m) instead of O(nm).
+         */
+        template<class InputIt>
+        void insert(InputIt first, InputIt last) {
+            key_vector newKeys(keys.get_allocator());
+            value_vector newVals(vals.get_allocator());
+            for(; first != last; ++first) {
+                newKeys.push_back((*first).first);
+                newVals.push_back((*first).second);
+            }
+            size_t m = newKeys.size();
+            if(m == 0) return;
+
+            index_vector order(m, typename index_vector::allocator_type(keys.get_allocator()));
+            for(size_t i = 0; i < m; ++i) order.push_back(i);
+            const Key *nk = newKeys.data();
+            const Compare &c = cmp;
+            std::stable_sort(order.data(), order.data() + m,
+                             [nk, &c](size_t a, size_t b) { return c(nk[a], nk[b]); });
+
+            size_t n = keys.size();
+            key_vector mergedKeys(n + m, keys.get_allocator());
+            value_vector mergedVals(n + m, vals.get_allocator());
+            size_t i = 0;
+            for(size_t j = 0; j < m; ++j) {
+                size_t k = order.data()[j];
+                /// the earlier one among equal new keys has been taken.
+                if(j > 0 && !cmp(nk[order.data()[j - 1]], nk[k])) continue;
+                for(; i < n && cmp(keys.data()[i], nk[k]); ++i) {
+                    mergedKeys.push_back(std::move(keys.data()[i]));
+                    mergedVals.push_back(std::move(vals.data()[i]));
+                }
+                if(i < n && !cmp(nk[k], keys.data()[i])) continue;
+                mergedKeys.push_back(std::move(newKeys.data()[k]));
+                mergedVals.push_back(std::move(newVals.data()[k]));
+            }
+            for(; i < n; ++i) {
+                mergedKeys.push_back(std::move(keys.data()[i]));
+                mergedVals.push_back(std::move(vals.data()[i]));
+            }
+            keys.swap(mergedKeys);
+            vals.swap(mergedVals);
+        }
+        /**
+         * erase the element at pos.
+         *
+         * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
+         */
+        void erase(iterator pos) {
+            if(pos.owner != this) throw invalid_iterator();
+            if(pos.pos >= keys.size()) throw index_out_of_bound();
+            keys.erase(pos.pos);
+            vals.erase(pos.pos);
+        }
+        /**
+         * Returns the number of elements with key
+         *   that compares equivalent to the specified argument,
+         *   which is either 1 or 0
+         *     since this container does not allow duplicates.
+         */
+        size_t count(const Key &key) const { return indexOf(key) == keys.size() ? 0 : 1; }
+        /**
+         * Finds an element with key equivalent to key.
+         *   If no such element is found, past-the-end (see end()) iterator is returned.
+         */
+        iterator find(const Key &key) { return iterator(indexOf(key), this); }
+        const_iterator find(const Key &key) const { return const_iterator(indexOf(key), this); }
+        /// the first element whose key is not less than key.
+        iterator lower_bound(const Key &key) { return iterator(lowerIdx(key), this); }
+        const_iterator lower_bound(const Key &key) const { return const_iterator(lowerIdx(key), this); }
+    };
+}
+
+#endif
@@ -0,0 +1,244 @@
+/**
+ * implement a read-only map in Eytzinger order.
+ *
+ * the sorted keys are laid out like a heap in one array: the node k has
+ * its sons at 2k and 2k + 1, counting from 1, so the first levels of
+ * every search share a few cache lines, and the nodes four levels down
+ * are contiguous and can be prefetched in one go. a search is a loop
+ * without a branch on the comparison.
+ *
+ * it is built once from a sorted range, see map::freeze(), and never
+ * changes afterwards.
+ */
+#ifndef SJTU_FROZEN_MAP_HPP
+#define SJTU_FROZEN_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "vector.hpp"
+#include "three_way.hpp"
+
+namespace sjtu {
+
+    template<
+    class Key,
+    class T,
+    class Compare = std::less<Key>,
+    class Allocator = std::allocator<pair<const Key, T>>
+    > class frozen_map {
+    public:
+        typedef pair<const Key, T> value_type;
+        /// keys and values are apart, so an iterator yields a pair of references.
+        typedef pair<const Key &, const T &> const_reference;
+        typedef Allocator allocator_type;
+    private:
+        typedef std::allocator_traits<Allocator> alloc_traits;
+        typedef vector<Key, typename alloc_traits::template rebind_alloc<Key>> key_vector;
+        typedef vector<T, typename alloc_traits::template rebind_alloc<T>> value_vector;
+
+        /// the node k is kept at k - 1, and 0 stands for no node.
+        key_vector keys;
+        value_vector vals;
+        Compare cmp;
+
+        typedef std::integral_constant<bool, three_way_compare<Compare>::value> threeWay;
+        /// whether a goes before b, for a Compare of either kind, see treap.
+        bool keyLess(const Key &a, const Key &b) const { return keyLess(a, b, threeWay()); }
+        bool keyLess(const Key &a, const Key &b, std::false_type) const { return cmp(a, b); }
+        bool keyLess(const Key &a, const Key &b, std::true_type) const { return cmp(a, b) < 0; }
+
+        /** in-order neighbours of the node k in a heap of n nodes,
+         * 0 past either end. O(1) amortized over a walk. */
+        static size_t nextIdx(size_t k, size_t n) {
+            if(2 * k + 1 <= n) {
+                k = 2 * k + 1;
+                while(2 * k <= n) k = 2 * k;
+                return k;
+            }
+            /// climb while k is a right son, then once more.
+            while(k & 1) k >>= 1;
+            return k >> 1;
+        }
+        static size_t prevIdx(size_t k, size_t n) {
+            if(2 * k <= n) {
+                k = 2 * k;
+                while(2 * k + 1 <= n) k = 2 * k + 1;
+                return k;
+            }
+            while(k != 0 && !(k & 1)) k >>= 1;
+            return k >> 1;
+        }
+        static size_t firstIdx(size_t n) {
+            if(n == 0) return 0;
+            size_t k = 1;
+            while(2 * k <= n) k = 2 * k;
+            return k;
+        }
+        static size_t lastIdx(size_t n) {
+            if(n == 0) return 0;
+            size_t k = 1;
+            while(2 * k + 1 <= n) k = 2 * k + 1;
+            return k;
+        }
+
+        /**
+         * the node with the first key not less than key, 0 if there is none.
+         * k goes left or right by adding the comparison to 2k, no branch.
+         * when it falls off the tree, its low bits are the turns taken;
+         * the answer is where we last went left, so the trailing right
+         * turns (ones) and that left turn (a zero) are shifted away.
+         */
+        size_t lowerIdx(const Key &key) const {
+            const Key *base = keys.data();
+            size_t n = keys.size(), k = 1;
+            while(k <= n) {
+#if defined(__GNUC__)
+                /// the 16 nodes four levels below k, they are next to each other.
+                if(16 * k <= n) __builtin_prefetch(base + 16 * k - 1);
+#endif
+                k = 2 * k + keyLess(base[k - 1], key);
+            }
+#if defined(__GNUC__)
+            k >>= __builtin_ffsll(~(unsigned long long)k);
+#else
+            while(k & 1) k >>= 1;
+            k >>= 1;
+#endif
+            return k;
+        }
+        /// the node with key, or 0.
+        size_t indexOf(const Key &key) const {
+            size_t k = lowerIdx(key);
+            if(k != 0 && !keyLess(key, keys.data()[k - 1])) return k;
+            return 0;
+        }
+    public:
+        /**
+         * see BidirectionalIterator at CppReference for help.
+         * elements come in key order, the iterator steps through the heap.
+         *
+         * if there is anything wrong throw invalid_iterator.
+         *     like it = map.cbegin(); --it;
+         *       or it = map.cend(); ++end();
+         */
+        class const_iterator {
+            friend frozen_map;
+        private:
+            /// the node, 0 is cend().
+            size_t k;
+            const frozen_map *owner;
+
+            const_iterator(size_t idx, const frozen_map *o): k(idx), owner(o) {}
+        public:
+            struct pointer {
+                const_reference ref;
+                const_reference *operator->() { return &ref; }
+            };
+
+            const_iterator(): k(0), owner(nullptr) {}
+
+            const_iterator operator++(int) {
+                const_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            const_iterator & operator++() {
+                if(owner == nullptr || k == 0) throw invalid_iterator();
+                k = nextIdx(k, owner->size());
+                return *this;
+            }
+            const_iterator operator--(int) {
+                const_iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+            const_iterator & operator--() {
+                if(owner == nullptr) throw invalid_iterator();
+                size_t p = k == 0 ? lastIdx(owner->size()) : prevIdx(k, owner->size());
+                if(p == 0) throw invalid_iterator();
+                k = p;
+                return *this;
+            }
+            const_reference operator*() const {
+                if(owner == nullptr || k == 0) throw index_out_of_bound();
+                return const_reference(owner->keys.data()[k - 1], owner->vals.data()[k - 1]);
+            }
+            pointer operator->() const {
+                if(owner == nullptr || k == 0) throw invalid_iterator();
+                return pointer{const_reference(owner->keys.data()[k - 1], owner->vals.data()[k - 1])};
+            }
+            bool operator==(const const_iterator &rhs) const { return k == rhs.k && owner == rhs.owner; }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        };
+        typedef const_iterator iterator;
+
+        frozen_map(): frozen_map(Compare()) {}
+        explicit frozen_map(const Compare &c, const Allocator &a = Allocator()):
+        keys(typename key_vector::allocator_type(a)), vals(typename value_vector::allocator_type(a)), cmp(c) {}
+        /**
+         * build from a range of pairs, sorted by Compare and without equal keys,
+         * like a map. O(n): the elements are copied in order, then moved to
+         * their places in the heap.
+         */
+        template<class InputIt>
+        frozen_map(InputIt first, InputIt last, const Compare &c = Compare(), const Allocator &a = Allocator()):
+        frozen_map(c, a) {
+            key_vector sortedKeys(keys.get_allocator());
+            value_vector sortedVals(vals.get_allocator());
+            for(; first != last; ++first) {
+                sortedKeys.push_back((*first).first);
+                sortedVals.push_back((*first).second);
+            }
+            size_t n = sortedKeys.size();
+            /// rankOf[k - 1] is the place of the node k in key order.
+            vector<size_t, typename alloc_traits::template rebind_alloc<size_t>> rankOf(n, a);
+            for(size_t i = 0; i < n; ++i) rankOf.push_back(0);
+            size_t r = 0;
+            for(size_t k = firstIdx(n); k != 0; k = nextIdx(k, n)) rankOf.data()[k - 1] = r++;
+            keys.reserve(n);
+            vals.reserve(n);
+            for(size_t k = 1; k <= n; ++k) {
+                keys.push_back(std::move(sortedKeys.data()[rankOf.data()[k - 1]]));
+                vals.push_back(std::move(sortedVals.data()[rankOf.data()[k - 1]]));
+            }
+        }
+        frozen_map(const frozen_map &other) = default;
+        frozen_map(frozen_map &&other) = default;
+        frozen_map & operator=(const frozen_map &other) = default;
+        frozen_map & operator=(frozen_map &&other) = default;
+        ~frozen_map() = default;
+        allocator_type get_allocator() const { return allocator_type(keys.get_allocator()); }
+
+        const_iterator cbegin() const { return const_iterator(firstIdx(size()), this); }
+        const_iterator cend() const { return const_iterator(0, this); }
+
+        bool empty() const { return keys.empty(); }
+        size_t size() const { return keys.size(); }
+        /**
+         * Returns a reference to the mapped value of the element with key equivalent to key.
+         * If no such element exists, an exception of type `index_out_of_bound'
+         */
+        const T & at(const Key &key) const {
+            size_t k = indexOf(key);
+            if(k == 0) throw index_out_of_bound();
+            return vals.data()[k - 1];
+        }
+        const T & operator[](const Key &key) const { return at(key); }
+        size_t count(const Key &key) const { return indexOf(key) == 0 ? 0 : 1; }
+        /**
+         * Finds an element with key equivalent to key.
+         *   If no such element is found, past-the-end (see cend()) iterator is returned.
+         */
+        const_iterator find(const Key &key) const { return const_iterator(indexOf(key), this); }
+        /// the first element whose key is not less than key.
+        const_iterator lower_bound(const Key &key) const { return const_iterator(lowerIdx(key), this); }
+    };
+}
+
+#endif
@@ -0,0 +1,334 @@
+/**
+ * implement a persistent version of the treap in map.hpp.
+ *
+ * nodes never change once they are in a tree. an update copies the
+ * nodes on the path from the root to the changed key, O(log n) of them,
+ * and shares every other subtree with the old version. each node counts
+ * the parents and roots referring to it, and is freed when the count
+ * drops to 0.
+ *
+ * one thread writes through persistent_map. any thread may call
+ * snapshot() and get an immutable view in O(1), which it reads without
+ * locks while the writer keeps going. the writer publishes a new root
+ * under a spinlock held for a few instructions only.
+ */
+#ifndef SJTU_PERSISTENT_MAP_HPP
+#define SJTU_PERSISTENT_MAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "vector.hpp"
+
+namespace sjtu {
+
+    template<
+    class Key,
+    class T,
+    class Compare = std::less<Key>,
+    class Allocator = std::allocator<pair<const Key, T>>
+    > class persistent_map {
+    public:
+        typedef pair<const Key, T> value_type;
+        typedef Allocator allocator_type;
+    private:
+        /// this treap is a maximum heap, like map.
+        struct node {
+            value_type data;
+            int priority;
+            node *lson, *rson;
+            std::atomic<size_t> refs;
+
+            template<class... Args>
+            node(int p, node *l, node *r, Args&&... args):
+            data(std::forward<Args>(args)...), priority(p), lson(l), rson(r), refs(1) {}
+        };
+        typedef std::allocator_traits<Allocator> alloc_traits;
+        typedef typename alloc_traits::template rebind_alloc<node> node_allocator;
+        typedef std::allocator_traits<node_allocator> node_traits;
+
+        /// take one more reference to p.
+        static node *retain(node *p) {
+            if(p != nullptr) p->refs.fetch_add(1, std::memory_order_relaxed);
+            return p;
+        }
+        /// drop one reference to p, a node nobody refers to is freed with its subtree.
+        static void release(node *p, Allocator &alloc) {
+            while(p != nullptr && p->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                node *l = p->lson, *r = p->rson;
+                node_allocator nodeAlloc(alloc);
+                node_traits::destroy(nodeAlloc, p);
+                node_traits::deallocate(nodeAlloc, p, 1);
+                release(l, alloc);
+                p = r;
+            }
+        }
+        /// the node with key, or nullptr.
+        static const node *findNode(const node *p, const Key &key, const Compare &cmp) {
+            while(p != nullptr) {
+                if(cmp(key, p->data.first)) p = p->lson;
+                else if(cmp(p->data.first, key)) p = p->rson;
+                else return p;
+            }
+            return nullptr;
+        }
+
+        /// published root and size, guarded by lock.
+        node *root;
+        size_t elemSz;
+        mutable std::atomic_flag lock;
+        Compare cmp;
+        Allocator alloc;
+        unsigned seed;
+
+        int rand1() {
+            seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+            return int(seed >> 1);
+        }
+        template<class... Args>
+        node *newNode(int p, node *l, node *r, Args&&... args) {
+            node_allocator nodeAlloc(alloc);
+            node *ptr = node_traits::allocate(nodeAlloc, 1);
+            node_traits::construct(nodeAlloc, ptr, p, l, r, std::forward<Args>(args)...);
+            return ptr;
+        }
+
+        /** the following return a new tree, which owns one reference to its root.
+         * the trees passed in are only borrowed and left as they are. */
+
+        /// t without value.first in it, value is added.
+        node *insertPath(node *t, const value_type &value) {
+            if(t == nullptr) return newNode(rand1(), nullptr, nullptr, value);
+            if(cmp(value.first, t->data.first)) {
+                node *l = insertPath(t->lson, value);
+                node *c = newNode(t->priority, l, retain(t->rson), t->data);
+                if(l->priority <= c->priority) return c;
+                /// rotate right, both nodes are new copies.
+                c->lson = l->rson; l->rson = c;
+                return l;
+            }
+            else {
+                node *r = insertPath(t->rson, value);
+                node *c = newNode(t->priority, retain(t->lson), r, t->data);
+                if(r->priority <= c->priority) return c;
+                c->rson = r->lson; r->lson = c;
+                return r;
+            }
+        }
+        /// t with key in it, the mapped value of key is replaced by obj.
+        node *assignPath(node *t, const Key &key, const T &obj) {
+            if(cmp(key, t->data.first))
+                return newNode(t->priority, assignPath(t->lson, key, obj), retain(t->rson), t->data);
+            if(cmp(t->data.first, key))
+                return newNode(t->priority, retain(t->lson), assignPath(t->rson, key, obj), t->data);
+            return newNode(t->priority, retain(t->lson), retain(t->rson), t->data.first, obj);
+        }
+        /// every key in a goes before every key in b.
+        node *mergePath(node *a, node *b) {
+            if(a == nullptr) return retain(b);
+            if(b == nullptr) return retain(a);
+            if(a->priority > b->priority)
+                return newNode(a->priority, retain(a->lson), mergePath(a->rson, b), a->data);
+            return newNode(b->priority, mergePath(a, b->lson), retain(b->rson), b->data);
+        }
+        /// t with key in it, key is removed.
+        node *erasePath(node *t, const Key &key) {
+            if(cmp(key, t->data.first))
+                return newNode(t->priority, erasePath(t->lson, key), retain(t->rson), t->data);
+            if(cmp(t->data.first, key))
+                return newNode(t->priority, retain(t->lson), erasePath(t->rson, key), t->data);
+            return mergePath(t->lson, t->rson);
+        }
+
+        /// make nr the current version, and drop the writer's reference to the old one.
+        void publish(node *nr, size_t n) {
+            while(lock.test_and_set(std::memory_order_acquire)) ;
+            node *old = root;
+            root = nr;
+            elemSz = n;
+            lock.clear(std::memory_order_release);
+            release(old, alloc);
+        }
+    public:
+        /**
+         * an immutable view of the map at some moment.
+         * it keeps its nodes alive by itself, also after the map is gone,
+         * and any number of threads may read it at once.
+         */
+        class view {
+            friend persistent_map;
+        private:
+            node *root;
+            size_t elemSz;
+            Compare cmp;
+            Allocator alloc;
+
+            view(node *r, size_t n, const Compare &c, const Allocator &a): root(r), elemSz(n), cmp(c), alloc(a) {}
+        public:
+            /**
+             * in-order iterator, the path to the current node is kept on a stack.
+             * it is a forward iterator over const elements.
+             *
+             * if there is anything wrong throw invalid_iterator.
+             */
+            class const_iterator {
+                friend view;
+            private:
+                vector<const node *> path;
+
+                void pushLeft(const node *p) {
+                    for(; p != nullptr; p = p->lson) path.push_back(p);
+                }
+                const node *current() const { return path.empty() ? nullptr : path.back(); }
+            public:
+                const_iterator() {}
+
+                const_iterator operator++(int) {
+                    const_iterator tmp = *this;
+                    ++*this;
+                    return tmp;
+                }
+                const_iterator & operator++() {
+                    if(path.empty()) throw invalid_iterator();
+                    const node *p = path.back();
+                    path.pop_back();
+                    pushLeft(p->rson);
+                    return *this;
+                }
+                const value_type & operator*() const {
+                    if(path.empty()) throw index_out_of_bound();
+                    return path.back()->data;
+                }
+                const value_type* operator->() const {
+                    if(path.empty()) throw invalid_iterator();
+                    return &path.back()->data;
+                }
+                bool operator==(const const_iterator &rhs) const { return current() == rhs.current(); }
+                bool operator!=(const const_iterator &rhs) const { return current() != rhs.current(); }
+            };
+
+            view(const view &other): root(retain(other.root)), elemSz(other.elemSz), cmp(other.cmp), alloc(other.alloc) {}
+            view & operator=(const view &other) {
+                if(&other == this) return *this;
+                node *old = root;
+                root = retain(other.root);
+                elemSz = other.elemSz;
+                cmp = other.cmp;
+                release(old, alloc);
+                alloc = other.alloc;
+                return *this;
+            }
+            ~view() { release(root, alloc); }
+
+            const_iterator cbegin() const {
+                const_iterator citr;
+                citr.pushLeft(root);
+                return citr;
+            }
+            const_iterator cend() const { return const_iterator(); }
+            bool empty() const { return elemSz == 0; }
+            size_t size() const { return elemSz; }
+            /**
+             * Returns a reference to the mapped value of the element with key equivalent to key.
+             * If no such element exists, an exception of type `index_out_of_bound'
+             */
+            const T & at(const Key &key) const {
+                const node *p = findNode(root, key, cmp);
+                if(p == nullptr) throw index_out_of_bound();
+                return p->data.second;
+            }
+            size_t count(const Key &key) const { return findNode(root, key, cmp) != nullptr ? 1 : 0; }
+            /// the element with key, or cend().
+            const_iterator find(const Key &key) const {
+                const_iterator citr;
+                for(const node *p = root; p != nullptr; ) {
+                    if(cmp(key, p->data.first)) { citr.path.push_back(p); p = p->lson; }
+                    else if(cmp(p->data.first, key)) p = p->rson;
+                    else { citr.path.push_back(p); return citr; }
+                }
+                return const_iterator();
+            }
+        };
+
+        persistent_map(): persistent_map(Compare()) {}
+        explicit persistent_map(const Compare &c, const Allocator &a = Allocator()):
+        root(nullptr), elemSz(0), cmp(c), alloc(a), seed(2463534242u) {
+            lock.clear();
+        }
+        /// the copy shares all nodes with other, O(1).
+        persistent_map(const persistent_map &other):
+        root(nullptr), elemSz(0), cmp(other.cmp), alloc(other.alloc), seed(other.seed) {
+            lock.clear();
+            view s = other.snapshot();
+            root = retain(s.root);
+            elemSz = s.elemSz;
+        }
+        persistent_map & operator=(const persistent_map &other) {
+            if(&other == this) return *this;
+            view s = other.snapshot();
+            publish(retain(s.root), s.elemSz);
+            return *this;
+        }
+        ~persistent_map() { release(root, alloc); }
+
+        /**
+         * the current version as an immutable view, O(1).
+         * it may be called from any thread.
+         */
+        view snapshot() const {
+            while(lock.test_and_set(std::memory_order_acquire)) ;
+            node *r = retain(root);
+            size_t n = elemSz;
+            lock.clear(std::memory_order_release);
+            return view(r, n, cmp, alloc);
+        }
+
+        /** the following are for the writer thread only. */
+
+        bool empty() const { return elemSz == 0; }
+        size_t size() const { return elemSz; }
+        const T & at(const Key &key) const {
+            const node *p = findNode(root, key, cmp);
+            if(p == nullptr) throw index_out_of_bound();
+            return p->data.second;
+        }
+        size_t count(const Key &key) const { return findNode(root, key, cmp) != nullptr ? 1 : 0; }
+        /**
+         * insert value if its key is absent.
+         * return true if insert successfully, or false.
+         */
+        bool insert(const value_type &value) {
+            if(findNode(root, value.first, cmp) != nullptr) return false;
+            publish(insertPath(root, value), elemSz + 1);
+            return true;
+        }
+        /**
+         * insert key with obj, or replace the mapped value of key by obj.
+         * return true for an insertion.
+         */
+        bool insert_or_assign(const Key &key, const T &obj) {
+            if(findNode(root, key, cmp) == nullptr) {
+                publish(insertPath(root, value_type(key, obj)), elemSz + 1);
+                return true;
+            }
+            publish(assignPath(root, key, obj), elemSz);
+            return false;
+        }
+        /**
+         * remove the element with key, return the number of elements removed.
+         */
+        size_t erase(const Key &key) {
+            if(findNode(root, key, cmp) == nullptr) return 0;
+            publish(erasePath(root, key), elemSz - 1);
+            return 1;
+        }
+        void clear() { publish(nullptr, 0); }
+    };
+}
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <cstddef>
 #include <functional>
+#include <memory>
+#include <utility>
 #include "exceptions.hpp"
 #include "vector.hpp"
 
@@ -13,12 +15,14 @@ namespace sjtu {
      * it should be based on the vector written by yourself.
      *
      * NOTE: THIS IS A MAXIMUM HEAP!
+     * the storage of the underlying vector comes from Allocator.
      */
-    template<typename T, class Compare = std::less<T>>
+    template<typename T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
     class priority_queue {
-        
+    public:
+        typedef Allocator allocator_type;
     private:
-        vector<T> heap;
+        vector<T, Allocator> heap;
         size_t length;
         Compare comp;
         
@@ -54,11 +58,12 @@ namespace sjtu {
          * TODO constructors
          */
         priority_queue() { length = 0; };
-        priority_queue(const priority_queue &other) {
-            if(this == &other) return;
-            for(int i = 0; i < other.heap.size(); ++i)
-                heap.push_back(other.heap[i]);
-            length = other.length;
+        explicit priority_queue(const Allocator &a): heap(a), length(0) {}
+        explicit priority_queue(const Compare &c, const Allocator &a = Allocator()): heap(a), length(0), comp(c) {}
+        /** The vector takes care of the allocator. */
+        priority_queue(const priority_queue &other): heap(other.heap), length(other.length), comp(other.comp) {}
+        priority_queue(priority_queue &&other): heap(std::move(other.heap)), length(other.length), comp(other.comp) {
+            other.length = 0;
         }
         /**
          * TODO deconstructor
@@ -69,12 +74,27 @@ namespace sjtu {
          */
         priority_queue &operator=(const priority_queue &other) {
             if(this == &other) return *this;
-            heap.clear();
-            for(int i = 0; i < other.heap.size(); ++i)
-                heap.push_back(other.heap[i]);
+            heap = other.heap;
             length = other.length;
+            comp = other.comp;
             return *this;
         }
+        priority_queue &operator=(priority_queue &&other) {
+            if(this == &other) return *this;
+            heap = std::move(other.heap);
+            length = other.length;
+            comp = other.comp;
+            other.heap.clear();
+            other.length = 0;
+            return *this;
+        }
+        void swap(priority_queue &other) {
+            heap.swap(other.heap);
+            std::swap(length, other.length);
+            using std::swap;
+            swap(comp, other.comp);
+        }
+        allocator_type get_allocator() const { return heap.get_allocator(); }
         /**
          * get the top of the queue.
          * @return a reference of the top element.
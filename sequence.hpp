@@ -0,0 +1,499 @@
+/**
+ * implement a sequence: a list with O(log n) access, insertion and
+ * erasure at any position.
+ *
+ * it is an implicit treap. nodes are ordered by position, which is never
+ * stored but counted from the subtree sizes on the way down, so an edit
+ * in the middle doesn't renumber anything. nodes are rotated like the
+ * treap in treap.hpp, and this treap is a maximum heap too.
+ */
+#ifndef SJTU_SEQUENCE_HPP
+#define SJTU_SEQUENCE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include "exceptions.hpp"
+#include "treap_rotate.hpp"
+
+namespace sjtu {
+
+    template<class T, class Allocator = std::allocator<T>>
+    class sequence {
+    public:
+        typedef T value_type;
+        typedef Allocator allocator_type;
+    private:
+        /// size is the number of nodes in the subtree.
+        struct node {
+            node *parent, *lson, *rson;
+            size_t size;
+            int priority;
+            T value;
+
+            template<class... Args>
+            node(int p, Args&&... args):
+            parent(nullptr), lson(nullptr), rson(nullptr), size(1), priority(p), value(std::forward<Args>(args)...) {}
+        };
+        typedef std::allocator_traits<Allocator> alloc_traits;
+        typedef typename alloc_traits::template rebind_alloc<node> node_allocator;
+        typedef std::allocator_traits<node_allocator> node_traits;
+
+        node *root;
+        Allocator alloc;
+        unsigned seed;
+
+        int rand1() {
+            seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+            return int(seed >> 1);
+        }
+        template<class... Args>
+        node *newNode(Args&&... args) {
+            node_allocator nodeAlloc(alloc);
+            node *ptr = node_traits::allocate(nodeAlloc, 1);
+            node_traits::construct(nodeAlloc, ptr, rand1(), std::forward<Args>(args)...);
+            return ptr;
+        }
+        void deleteNode(node *ptr) {
+            node_allocator nodeAlloc(alloc);
+            node_traits::destroy(nodeAlloc, ptr);
+            node_traits::deallocate(nodeAlloc, ptr, 1);
+        }
+
+        static size_t sizeOf(const node *p) { return p == nullptr ? 0 : p->size; }
+        static void pull(node *p) { p->size = sizeOf(p->lson) + sizeOf(p->rson) + 1; }
+        static void pullUp(node *p) {
+            for(; p != nullptr; p = p->parent) pull(p);
+        }
+        /// the new top takes the place of root when p was the root.
+        node *r_rt(node *p) {
+            node *nt = treap_rotate_right(p);
+            pull(p); pull(nt);
+            if(nt->parent == nullptr) root = nt;
+            return nt;
+        }
+        node *l_rt(node *p) {
+            node *nt = treap_rotate_left(p);
+            pull(p); pull(nt);
+            if(nt->parent == nullptr) root = nt;
+            return nt;
+        }
+
+        /** the node at index k, k must be less than size(). */
+        node *kth(size_t k) const {
+            node *ptr = root;
+            while(true) {
+                size_t lsz = sizeOf(ptr->lson);
+                if(k < lsz) ptr = ptr->lson;
+                else if(k == lsz) return ptr;
+                else { k -= lsz + 1; ptr = ptr->rson; }
+            }
+        }
+        /** hang the new node x where it gets index k, k <= size().
+         * every node on the way gains one in its subtree, then x is
+         * rotated up along its parents. */
+        void linkAt(size_t k, node *x) {
+            if(root == nullptr) { root = x; return; }
+            node *par = root;
+            while(true) {
+                ++par->size;
+                if(k <= sizeOf(par->lson)) {
+                    if(par->lson == nullptr) { par->lson = x; break; }
+                    par = par->lson;
+                }
+                else {
+                    k -= sizeOf(par->lson) + 1;
+                    if(par->rson == nullptr) { par->rson = x; break; }
+                    par = par->rson;
+                }
+            }
+            x->parent = par;
+            while(x->parent && x->priority > x->parent->priority) {
+                if(x == x->parent->lson) x = r_rt(x->parent);
+                else x = l_rt(x->parent);
+            }
+        }
+        /** rotate x down until it has no son, then cut it off. */
+        void unlink(node *x) {
+            while(x->lson || x->rson) {
+                if(x->rson == nullptr || (x->lson && x->lson->priority > x->rson->priority)) r_rt(x);
+                else l_rt(x);
+            }
+            if(x->parent == nullptr) { root = nullptr; return; }
+            if(x == x->parent->lson) x->parent->lson = nullptr;
+            else x->parent->rson = nullptr;
+            for(node *anc = x->parent; anc != nullptr; anc = anc->parent) --anc->size;
+        }
+        /** split the treap t into lower, the first k nodes, and upper.
+         * walk down once, hanging every node on the right spine of lower
+         * or the left spine of upper. */
+        static void splitTree(node *t, size_t k, node *&lower, node *&upper) {
+            node *lroot = nullptr, *rroot = nullptr;
+            node **lhole = &lroot, **rhole = &rroot;
+            node *lpar = nullptr, *rpar = nullptr;
+            while(t != nullptr) {
+                if(sizeOf(t->lson) < k) {
+                    k -= sizeOf(t->lson) + 1;
+                    *lhole = t; t->parent = lpar; lpar = t;
+                    lhole = &t->rson; t = t->rson;
+                }
+                else {
+                    *rhole = t; t->parent = rpar; rpar = t;
+                    rhole = &t->lson; t = t->lson;
+                }
+            }
+            *lhole = nullptr; *rhole = nullptr;
+            pullUp(lpar); pullUp(rpar);
+            lower = lroot; upper = rroot;
+        }
+        /** merge two treaps, a goes before b.
+         * walk down the right spine of a and the left spine of b together. */
+        static node *mergeTree(node *a, node *b) {
+            node *ret = nullptr, **hole = &ret, *par = nullptr;
+            while(a != nullptr && b != nullptr) {
+                if(a->priority > b->priority) {
+                    *hole = a; a->parent = par; par = a;
+                    hole = &a->rson; a = a->rson;
+                }
+                else {
+                    *hole = b; b->parent = par; par = b;
+                    hole = &b->lson; b = b->lson;
+                }
+            }
+            *hole = a != nullptr ? a : b;
+            if(*hole != nullptr) (*hole)->parent = par;
+            pullUp(par);
+            return ret;
+        }
+        /** append x after the last node. spine is the last node, and walks
+         * up the right spine like the stack of a Cartesian tree build; the
+         * rest waits for pullUp(spine). O(1) amortized. */
+        void appendNode(node *x, node *&spine) {
+            node *popped = nullptr;
+            while(spine != nullptr && spine->priority < x->priority) {
+                pull(spine);
+                popped = spine; spine = spine->parent;
+            }
+            x->lson = popped;
+            if(popped) popped->parent = x;
+            x->parent = spine;
+            if(spine) spine->rson = x; else root = x;
+            spine = x;
+        }
+        /// copy p with the same priorities, hence the same shape.
+        node *cloneTree(const node *p, node *par) {
+            if(p == nullptr) return nullptr;
+            node_allocator nodeAlloc(alloc);
+            node *ptr = node_traits::allocate(nodeAlloc, 1);
+            node_traits::construct(nodeAlloc, ptr, p->priority, p->value);
+            ptr->parent = par;
+            ptr->size = p->size;
+            ptr->lson = cloneTree(p->lson, ptr);
+            ptr->rson = cloneTree(p->rson, ptr);
+            return ptr;
+        }
+        void destroy(node *p) {
+            while(p != nullptr) {
+                destroy(p->lson);
+                node *r = p->rson;
+                deleteNode(p);
+                p = r;
+            }
+        }
+        static node *leftmost(node *p) {
+            while(p->lson != nullptr) p = p->lson;
+            return p;
+        }
+        static node *rightmost(node *p) {
+            while(p->rson != nullptr) p = p->rson;
+            return p;
+        }
+    public:
+        /**
+         * bidirectional iterator, it walks the treap in order through the
+         * parent links, O(1) amortized per step.
+         *
+         * if there is anything wrong throw invalid_iterator.
+         *     like it = seq.begin(); --it;
+         *       or it = seq.end(); ++end();
+         */
+        class const_iterator;
+        class iterator {
+            friend sequence;
+            friend const_iterator;
+        private:
+            /// nullptr is end().
+            node *p;
+            const sequence *owner;
+
+            iterator(node *ptr, const sequence *o): p(ptr), owner(o) {}
+        public:
+            iterator(): p(nullptr), owner(nullptr) {}
+
+            iterator operator++(int) {
+                iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            iterator & operator++() {
+                if(p == nullptr) throw invalid_iterator();
+                if(p->rson != nullptr) p = leftmost(p->rson);
+                else {
+                    while(p->parent != nullptr && p == p->parent->rson) p = p->parent;
+                    p = p->parent;
+                }
+                return *this;
+            }
+            iterator operator--(int) {
+                iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+            iterator & operator--() {
+                if(owner == nullptr || owner->root == nullptr) throw invalid_iterator();
+                if(p == nullptr) { p = rightmost(owner->root); return *this; }
+                node *q = p;
+                if(q->lson != nullptr) q = rightmost(q->lson);
+                else {
+                    while(q->parent != nullptr && q == q->parent->lson) q = q->parent;
+                    q = q->parent;
+                    if(q == nullptr) throw invalid_iterator();
+                }
+                p = q;
+                return *this;
+            }
+            T & operator*() const {
+                if(p == nullptr) throw index_out_of_bound();
+                return p->value;
+            }
+            T * operator->() const {
+                if(p == nullptr) throw invalid_iterator();
+                return &p->value;
+            }
+            bool operator==(const iterator &rhs) const { return p == rhs.p && owner == rhs.owner; }
+            bool operator==(const const_iterator &rhs) const { return p == rhs.p && owner == rhs.owner; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        };
+        class const_iterator {
+            friend sequence;
+            friend iterator;
+        private:
+            const node *p;
+            const sequence *owner;
+
+            const_iterator(const node *ptr, const sequence *o): p(ptr), owner(o) {}
+        public:
+            const_iterator(): p(nullptr), owner(nullptr) {}
+            const_iterator(const iterator &other): p(other.p), owner(other.owner) {}
+
+            const_iterator operator++(int) {
+                const_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            const_iterator & operator++() {
+                iterator itr(const_cast<node *>(p), owner);
+                ++itr;
+                p = itr.p;
+                return *this;
+            }
+            const_iterator operator--(int) {
+                const_iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+            const_iterator & operator--() {
+                iterator itr(const_cast<node *>(p), owner);
+                --itr;
+                p = itr.p;
+                return *this;
+            }
+            const T & operator*() const {
+                if(p == nullptr) throw index_out_of_bound();
+                return p->value;
+            }
+            const T * operator->() const {
+                if(p == nullptr) throw invalid_iterator();
+                return &p->value;
+            }
+            bool operator==(const iterator &rhs) const { return p == rhs.p && owner == rhs.owner; }
+            bool operator==(const const_iterator &rhs) const { return p == rhs.p && owner == rhs.owner; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        };
+
+        sequence(): sequence(Allocator()) {}
+        explicit sequence(const Allocator &a): root(nullptr), alloc(a), seed(2463534242u) {}
+        /// the treap is cloned in O(n) with the same shape.
+        sequence(const sequence &other):
+        root(nullptr), alloc(alloc_traits::select_on_container_copy_construction(other.alloc)), seed(other.seed) {
+            root = cloneTree(other.root, nullptr);
+        }
+        /// built in O(n) without any rotation.
+        template<class InputIt>
+        sequence(InputIt first, InputIt last, const Allocator &a = Allocator()): sequence(a) {
+            node *spine = nullptr;
+            for(; first != last; ++first) appendNode(newNode(*first), spine);
+            pullUp(spine);
+        }
+        /// other is left empty.
+        sequence(sequence &&other): root(other.root), alloc(other.alloc), seed(other.seed) { other.root = nullptr; }
+        sequence & operator=(const sequence &other) {
+            if(&other == this) return *this;
+            clear();
+            if(alloc_traits::propagate_on_container_copy_assignment::value) alloc = other.alloc;
+            root = cloneTree(other.root, nullptr);
+            return *this;
+        }
+        sequence & operator=(sequence &&other) {
+            if(&other == this) return *this;
+            clear();
+            if(alloc_traits::propagate_on_container_move_assignment::value || alloc == other.alloc) {
+                if(alloc_traits::propagate_on_container_move_assignment::value) alloc = other.alloc;
+                root = other.root;
+                other.root = nullptr;
+            }
+            else {
+                root = cloneTree(other.root, nullptr);
+                other.clear();
+            }
+            return *this;
+        }
+        ~sequence() { clear(); }
+        allocator_type get_allocator() const { return alloc; }
+
+        iterator begin() { return iterator(root == nullptr ? nullptr : leftmost(root), this); }
+        const_iterator cbegin() const { return const_iterator(root == nullptr ? nullptr : leftmost(root), this); }
+        iterator end() { return iterator(nullptr, this); }
+        const_iterator cend() const { return const_iterator(nullptr, this); }
+
+        bool empty() const { return root == nullptr; }
+        size_t size() const { return sizeOf(root); }
+        void clear() {
+            destroy(root);
+            root = nullptr;
+        }
+
+        /**
+         * access the element with index pos, O(log n).
+         * throw index_out_of_bound if pos is not in [0, size)
+         */
+        T & at(const size_t &pos) {
+            if(pos >= size()) throw index_out_of_bound();
+            return kth(pos)->value;
+        }
+        const T & at(const size_t &pos) const {
+            if(pos >= size()) throw index_out_of_bound();
+            return kth(pos)->value;
+        }
+        T & operator[](const size_t &pos) { return at(pos); }
+        const T & operator[](const size_t &pos) const { return at(pos); }
+        /**
+         * access the first or the last element.
+         * throw container_is_empty if size == 0
+         */
+        const T & front() const {
+            if(root == nullptr) throw container_is_empty();
+            return leftmost(root)->value;
+        }
+        const T & back() const {
+            if(root == nullptr) throw container_is_empty();
+            return rightmost(root)->value;
+        }
+
+        /**
+         * inserts value at index ind, O(log n).
+         * after inserting, this->at(ind) == value is true
+         * returns an iterator pointing to the inserted value.
+         * throw index_out_of_bound if ind > size
+         */
+        iterator insert(const size_t &ind, const T &value) { return emplace(ind, value); }
+        iterator insert(const size_t &ind, T &&value) { return emplace(ind, std::move(value)); }
+        /**
+         * constructs an element in place at index ind.
+         * throw index_out_of_bound if ind > size
+         */
+        template<class... Args>
+        iterator emplace(const size_t &ind, Args&&... args) {
+            if(ind > size()) throw index_out_of_bound();
+            node *x = newNode(std::forward<Args>(args)...);
+            linkAt(ind, x);
+            return iterator(x, this);
+        }
+        void push_back(const T &value) { emplace(size(), value); }
+        void push_back(T &&value) { emplace(size(), std::move(value)); }
+        void push_front(const T &value) { emplace(0, value); }
+        void push_front(T &&value) { emplace(0, std::move(value)); }
+        /**
+         * removes the element with index ind, O(log n).
+         * return an iterator pointing to the following element.
+         * throw index_out_of_bound if ind >= size
+         */
+        iterator erase(const size_t &ind) {
+            if(ind >= size()) throw index_out_of_bound();
+            node *x = kth(ind);
+            iterator nxt(x, this);
+            ++nxt;
+            unlink(x);
+            deleteNode(x);
+            return nxt;
+        }
+        /**
+         * removes the elements with index in [first, last).
+         * the range is cut out by two splits and one merge in O(log n),
+         * then its elements are destroyed.
+         * throw index_out_of_bound if first > last or last > size
+         */
+        void erase(const size_t &first, const size_t &last) {
+            if(first > last || last > size()) throw index_out_of_bound();
+            if(first == last) return;
+            node *lower, *mid, *upper;
+            splitTree(root, first, lower, mid);
+            splitTree(mid, last - first, mid, upper);
+            root = mergeTree(lower, upper);
+            destroy(mid);
+        }
+        /**
+         * remove the first or the last element.
+         * throw container_is_empty if size == 0
+         */
+        void pop_back() {
+            if(root == nullptr) throw container_is_empty();
+            erase(size() - 1);
+        }
+        void pop_front() {
+            if(root == nullptr) throw container_is_empty();
+            erase(0);
+        }
+
+        /**
+         * move the elements with index not less than ind into a new sequence,
+         * which is returned. nodes are relinked in O(log n), nothing is copied.
+         * throw index_out_of_bound if ind > size
+         */
+        sequence split_at(const size_t &ind) {
+            if(ind > size()) throw index_out_of_bound();
+            sequence ret(alloc);
+            splitTree(root, ind, root, ret.root);
+            return ret;
+        }
+        /**
+         * append all the elements of other, which is left empty.
+         * the two treaps are merged in O(log n); if the allocators differ,
+         * the elements are copied one by one instead.
+         */
+        void concat(sequence &&other) {
+            if(&other == this || other.root == nullptr) return;
+            if(alloc != other.alloc) {
+                for(const_iterator citr = other.cbegin(); citr != other.cend(); ++citr) push_back(*citr);
+                other.clear();
+                return;
+            }
+            root = mergeTree(root, other.root);
+            other.root = nullptr;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * implement a container like std::set, and std::multiset,
+ * on the treap in treap.hpp.
+ *
+ * a node keeps the key alone, so a set costs no more than the treap
+ * links and the key per element.
+ */
+#ifndef SJTU_SET_HPP
+#define SJTU_SET_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "treap.hpp"
+
+namespace sjtu {
+
+    /// a set node keeps the key, which is also its own mapped value.
+    /// it is const, so the elements can't be changed through iterators.
+    template<class Key>
+    struct set_traits {
+        typedef const Key value_type;
+
+        static const Key &key(const Key &v) { return v; }
+        static const Key &mapped(const Key &v) { return v; }
+    };
+
+    template<
+    class Key,
+    class Compare = std::less<Key>,
+    class Allocator = std::allocator<Key>
+    > class set : public treap<Key, set_traits<Key>, Compare, Allocator, no_aggregate, false> {
+        typedef treap<Key, set_traits<Key>, Compare, Allocator, no_aggregate, false> base;
+    public:
+        typedef Key key_type;
+        typedef Key value_type;
+        typedef typename base::iterator iterator;
+        typedef typename base::const_iterator const_iterator;
+
+        using base::base;
+        set() {}
+
+        /**
+         * move the elements not less than key into a new set,
+         * which is returned. see map::split.
+         */
+        set split(const Key &key) {
+            set ret(this->cmp, this->alloc);
+            this->splitInto(key, ret);
+            return ret;
+        }
+    };
+
+    /**
+     * a set which keeps equal keys, in the order they are inserted.
+     * count and equal_range take O(log n) from the subtree sizes,
+     * erase(key) cuts all the equal keys out at once.
+     */
+    template<
+    class Key,
+    class Compare = std::less<Key>,
+    class Allocator = std::allocator<Key>
+    > class multiset : public treap<Key, set_traits<Key>, Compare, Allocator, no_aggregate, true> {
+        typedef treap<Key, set_traits<Key>, Compare, Allocator, no_aggregate, true> base;
+    public:
+        typedef Key key_type;
+        typedef Key value_type;
+        typedef typename base::iterator iterator;
+        typedef typename base::const_iterator const_iterator;
+
+        using base::base;
+        multiset() {}
+
+        /// insertion always succeeds, after the equal keys.
+        iterator insert(const Key &key) { return base::insert(key).first; }
+        /// insert as close as possible before hint.
+        iterator insert(const_iterator hint, const Key &key) { return base::insert(hint, key); }
+        template<class... Args>
+        iterator emplace(Args&&... args) { return base::emplace(std::forward<Args>(args)...).first; }
+
+        multiset split(const Key &key) {
+            multiset ret(this->cmp, this->alloc);
+            this->splitInto(key, ret);
+            return ret;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,23 @@
+/**
+ * tell comparators returning an int from those returning a bool.
+ */
+#ifndef SJTU_THREE_WAY_HPP
+#define SJTU_THREE_WAY_HPP
+
+#include <type_traits>
+
+namespace sjtu {
+
+    /**
+     * a comparator may declare `typedef void is_three_way;', then its
+     * operator() returns a negative, zero or positive int like strcmp,
+     * and the map tells less, equal and greater apart with one call.
+     */
+    template<class C, class = void>
+    struct three_way_compare : std::false_type {};
+    template<class C>
+    struct three_way_compare<C, typename std::conditional<true, void, typename C::is_three_way>::type> :
+    std::true_type {};
+}
+
+#endif
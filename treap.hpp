@@ -0,0 +1,1721 @@
+/**
+ * implement the treap under map, multimap, set and multiset.
+ *
+ * implement insert with recursion and erase without recursion,
+ * because insert needs to do backTrack with rotation.
+ *
+ * this treap is a maximum heap. it stores value_type of Traits in the
+ * nodes and orders them by Traits::key(value); the containers differ
+ * only in Traits and in whether equal keys are allowed (Multi).
+ */
+#ifndef SJTU_TREAP_HPP
+#define SJTU_TREAP_HPP
+
+// only for std::less<T>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "three_way.hpp"
+#include "treap_rotate.hpp"
+
+namespace sjtu {
+    
+    /**
+     * the default Monoid of map, which keeps no aggregate.
+     * a Monoid has value_type for the aggregate, identity(), lift(key, mapped)
+     * for a single element, and combine(a, b) for a range a followed by a
+     * range b. combine must be associative, but need not be commutative.
+     */
+    struct no_aggregate {
+        struct value_type {};
+        value_type identity() const { return value_type(); }
+        template<class K, class V>
+        value_type lift(const K &, const V &) const { return value_type(); }
+        value_type combine(const value_type &, const value_type &) const { return value_type(); }
+    };
+    /// the sum of mapped values.
+    template<class T>
+    struct sum_aggregate {
+        typedef T value_type;
+        T identity() const { return T(); }
+        template<class K>
+        T lift(const K &, const T &v) const { return v; }
+        T combine(const T &a, const T &b) const { return a + b; }
+    };
+    /// the least and the greatest mapped value.
+    /// the identity is the bound from numeric_limits, which T must specialize.
+    template<class T>
+    struct min_aggregate {
+        static_assert(std::numeric_limits<T>::is_specialized, "min_aggregate needs numeric_limits<T>");
+        typedef T value_type;
+        T identity() const { return std::numeric_limits<T>::max(); }
+        template<class K>
+        T lift(const K &, const T &v) const { return v; }
+        T combine(const T &a, const T &b) const { return b < a ? b : a; }
+    };
+    template<class T>
+    struct max_aggregate {
+        static_assert(std::numeric_limits<T>::is_specialized, "max_aggregate needs numeric_limits<T>");
+        typedef T value_type;
+        T identity() const { return std::numeric_limits<T>::lowest(); }
+        template<class K>
+        T lift(const K &, const T &v) const { return v; }
+        T combine(const T &a, const T &b) const { return a < b ? b : a; }
+    };
+    /// the aggregate stored in a node, nothing for no_aggregate.
+    template<class A, bool Keep>
+    struct aggregate_box { A agg; };
+    template<class A>
+    struct aggregate_box<A, false> {};
+    
+    /**
+     * Traits gives value_type, the type kept in a node, key(value) and
+     * mapped(value), the part a Monoid and the set operations look at.
+     * with Multi, equal keys are kept in the order they are inserted.
+     */
+    template<
+    class Key,
+    class Traits,
+    class Compare,
+    class Allocator,
+    class Monoid,
+    bool Multi
+    > class treap {
+    public:
+        /**
+         * the internal type of data.
+         * it should have a default constructor, a copy constructor.
+         */
+        typedef typename Traits::value_type value_type;
+        typedef Allocator allocator_type;
+        typedef typename Monoid::value_type aggregate_type;
+    protected:
+        /// whether nodes keep the aggregate of their subtrees.
+        static const bool augmented = !std::is_same<Monoid, no_aggregate>::value;
+        
+        /// every map has its own generator. the only state maps may share is
+        /// the node pool after split(), which is locked while shared.
+        inline int rand1(){
+            return seed=int(seed*1103515245LL%2147483647);
+        }
+        
+        /// links of the treap and of the linked list, sentinels are bare nodes.
+        /// size is the number of nodes in the subtree.
+        struct node {
+            int priority;
+            size_t size;
+            node *parent, *lson, *rson, *prev, *next;
+            
+            node(int p) {
+                priority = p;
+                size = 1;
+                parent = lson = rson = prev = next = nullptr;
+            }
+        };
+        /// the value is stored inline, a node and its value are one allocation.
+        /// it is built in place by newNode, and destroyed by deleteNode.
+        struct slot : node, aggregate_box<aggregate_type, augmented> {
+            typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type data;
+            
+            slot(int p): node(p) {}
+        };
+        
+        static value_type &dataOf(node *p) { return reinterpret_cast<value_type &>(static_cast<slot *>(p)->data); }
+        static const value_type &dataOf(const node *p) {
+            return reinterpret_cast<const value_type &>(static_cast<const slot *>(p)->data);
+        }
+        static const Key &keyOf(const node *p) { return Traits::key(dataOf(p)); }
+        static bool isSentinel(const node *p) { return p->prev == nullptr || p->next == nullptr; }
+        static size_t sizeOf(const node *p) { return p == nullptr ? 0 : p->size; }
+        /// recompute the subtree size of p from its sons, and its aggregate if any.
+        void pull(node *p) const {
+            p->size = sizeOf(p->lson) + sizeOf(p->rson) + 1;
+            pullAggregate(p, std::integral_constant<bool, augmented>());
+        }
+        void pullAggregate(node *, std::false_type) const {}
+        void pullAggregate(node *p, std::true_type) const {
+            static_cast<slot *>(p)->agg = mono.combine(mono.combine(aggOf(p->lson), liftOf(p)), aggOf(p->rson));
+        }
+        aggregate_type liftOf(const node *p) const {
+            const value_type &v = dataOf(p);
+            return mono.lift(Traits::key(v), Traits::mapped(v));
+        }
+        aggregate_type aggOf(const node *p) const {
+            return p == nullptr ? mono.identity() : static_cast<const slot *>(p)->agg;
+        }
+        
+        typedef std::allocator_traits<Allocator> alloc_traits;
+        typedef typename alloc_traits::template rebind_alloc<node> node_allocator;
+        typedef std::allocator_traits<node_allocator> node_traits;
+        typedef typename alloc_traits::template rebind_alloc<slot> slot_allocator;
+        typedef std::allocator_traits<slot_allocator> slot_traits;
+        
+        /**
+         * a slab pool of slots.
+         * slots are cut from chunks allocated by the allocator, chunk length
+         * doubles from minChunk to maxChunk. erased slots go to a free list
+         * and are reused first. the first slot of every chunk is a header
+         * which links all chunks, so the whole pool is released at once.
+         *
+         * maps made by split() share the pool of their origin, refs counts
+         * the maps using it. they may live in different threads, so get, put
+         * and absorb hold latch while refs > 1. only a map using the pool can
+         * raise refs, so a map which sees refs == 1 is alone and locks nothing.
+         */
+        struct node_pool {
+            struct chunk_header { slot *nextChunk; size_t len; };
+            struct free_slot { slot *next; };
+            static const size_t minChunk = 16, maxChunk = 4096;
+            
+            slot *chunkList, *chunkTail, *freeList, *bumpPtr, *bumpEnd;
+            size_t chunkLen;
+            std::atomic<size_t> refs;
+            std::atomic_flag latch;
+            
+            node_pool(): chunkList(nullptr), chunkTail(nullptr), freeList(nullptr),
+            bumpPtr(nullptr), bumpEnd(nullptr), chunkLen(minChunk), refs(1) {
+                latch.clear();
+            }
+            
+            /// holds the latch of a shared pool for its lifetime.
+            struct guard {
+                node_pool &pool;
+                bool held;
+                
+                explicit guard(node_pool &p): pool(p), held(p.refs.load(std::memory_order_acquire) > 1) {
+                    if(held) while(pool.latch.test_and_set(std::memory_order_acquire)) ;
+                }
+                ~guard() { if(held) pool.latch.clear(std::memory_order_release); }
+            };
+            
+            slot *get(Allocator &alloc) {
+                guard g(*this);
+                if(freeList != nullptr) {
+                    slot *ptr = freeList;
+                    freeList = reinterpret_cast<free_slot *>(ptr)->next;
+                    return ptr;
+                }
+                if(bumpPtr == bumpEnd) {
+                    slot_allocator slotAlloc(alloc);
+                    slot *chunk = slot_traits::allocate(slotAlloc, chunkLen);
+                    chunk_header *header = reinterpret_cast<chunk_header *>(chunk);
+                    header->nextChunk = chunkList; header->len = chunkLen;
+                    if(chunkList == nullptr) chunkTail = chunk;
+                    chunkList = chunk;
+                    bumpPtr = chunk + 1; bumpEnd = chunk + chunkLen;
+                    if(chunkLen < maxChunk) chunkLen *= 2;
+                }
+                return bumpPtr++;
+            }
+            void put(slot *ptr) {
+                guard g(*this);
+                reinterpret_cast<free_slot *>(ptr)->next = freeList;
+                freeList = ptr;
+            }
+            /// give every chunk back, objects in the slots must have been destroyed.
+            void release(Allocator &alloc) {
+                slot_allocator slotAlloc(alloc);
+                while(chunkList != nullptr) {
+                    chunk_header *header = reinterpret_cast<chunk_header *>(chunkList);
+                    slot *nextChunk = header->nextChunk;
+                    slot_traits::deallocate(slotAlloc, chunkList, header->len);
+                    chunkList = nextChunk;
+                }
+                chunkTail = freeList = bumpPtr = bumpEnd = nullptr;
+                chunkLen = minChunk;
+            }
+            /// take over the chunks of other in O(1).
+            /// other's free list and bump space are kept only if ours are empty,
+            /// otherwise those slots stay unused until the pool is released.
+            void absorb(node_pool &other) {
+                if(other.chunkList == nullptr) return;
+                guard g(*this);
+                if(chunkList == nullptr) chunkList = other.chunkList;
+                else reinterpret_cast<chunk_header *>(chunkTail)->nextChunk = other.chunkList;
+                chunkTail = other.chunkTail;
+                if(freeList == nullptr) freeList = other.freeList;
+                if(bumpPtr == bumpEnd) { bumpPtr = other.bumpPtr; bumpEnd = other.bumpEnd; }
+                other.chunkList = other.chunkTail = other.freeList = other.bumpPtr = other.bumpEnd = nullptr;
+            }
+        };
+        typedef typename alloc_traits::template rebind_alloc<node_pool> pool_allocator;
+        typedef std::allocator_traits<pool_allocator> pool_traits;
+        
+        /// head and tail are sentinel nodes.
+        node *root, *head, *tail;
+        size_t elemSz;
+        Compare cmp;
+        Allocator alloc;
+        Monoid mono;
+        /// created on the first insertion.
+        node_pool *pool;
+        int seed;
+        
+        slot *newSlot(int p) {
+            if(pool == nullptr) {
+                pool_allocator poolAlloc(alloc);
+                pool = pool_traits::allocate(poolAlloc, 1);
+                new (pool) node_pool();
+            }
+            slot *ptr = pool->get(alloc);
+            new (ptr) slot(p);
+            return ptr;
+        }
+        /// a node whose value is constructed from args.
+        template<class... Args>
+        node *newNode(int p, Args&&... args) {
+            slot *ptr = newSlot(p);
+            new (&ptr->data) value_type(std::forward<Args>(args)...);
+            return ptr;
+        }
+        /** a node whose key is constructed from k and mapped value from args,
+         * by Traits::construct, which only maps have. */
+        template<class K, class... Args>
+        node *newNodePiecewise(int p, K &&k, Args&&... args) {
+            slot *ptr = newSlot(p);
+            Traits::construct(&dataOf(ptr), std::forward<K>(k), std::forward<Args>(args)...);
+            return ptr;
+        }
+        /// destroy the value and the aggregate of ptr, the slot stays in the pool.
+        static void destroyNode(node *ptr) {
+            dataOf(ptr).~value_type();
+            static_cast<slot *>(ptr)->~slot();
+        }
+        void deleteNode(node *ptr) {
+            destroyNode(ptr);
+            pool->put(static_cast<slot *>(ptr));
+        }
+        /// stop using the pool, it is released when no map uses it.
+        void dropPool() {
+            if(pool == nullptr) return;
+            if(pool->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                pool->release(alloc);
+                pool_allocator poolAlloc(alloc);
+                pool_traits::deallocate(poolAlloc, pool, 1);
+            }
+            pool = nullptr;
+        }
+        /// sentinels don't live in the pool, so that clear() can drop the pool as a whole.
+        node *newSentinel() {
+            node_allocator nodeAlloc(alloc);
+            node *ptr = node_traits::allocate(nodeAlloc, 1);
+            new (ptr) node(rand1());
+            return ptr;
+        }
+        void deleteSentinel(node *ptr) {
+            node_allocator nodeAlloc(alloc);
+            node_traits::deallocate(nodeAlloc, ptr, 1);
+        }
+        
+        void swapTree(treap &other) {
+            std::swap(root, other.root);
+            std::swap(head, other.head);
+            std::swap(tail, other.tail);
+            std::swap(elemSz, other.elemSz);
+            std::swap(cmp, other.cmp);
+            std::swap(mono, other.mono);
+            std::swap(pool, other.pool);
+        }
+        
+        typedef std::integral_constant<bool, three_way_compare<Compare>::value> threeWay;
+        /// whether a goes before b, for a Compare of either kind.
+        template<class A, class B>
+        bool keyLess(const A &a, const B &b) const { return keyLess(a, b, threeWay()); }
+        template<class A, class B>
+        bool keyLess(const A &a, const B &b, std::false_type) const { return cmp(a, b); }
+        template<class A, class B>
+        bool keyLess(const A &a, const B &b, std::true_type) const { return cmp(a, b) < 0; }
+    public:
+        
+        /**
+         * see BidirectionalIterator at CppReference for help.
+         *
+         * if there is anything wrong throw invalid_iterator.
+         *     like it = map.begin(); --it;
+         *       or it = map.end(); ++end();
+         */
+        class const_iterator;
+        class iterator {
+            friend const_iterator;
+            friend treap;
+        private:
+            /**
+             * TODO add data members
+             *   just add whatever you want.
+             */
+            node *p;
+            node *headId;
+        public:
+            iterator() {
+                // TODO
+                p = nullptr;
+                headId = nullptr;
+            }
+            iterator(const iterator &other) {
+                // TODO
+                p = other.p;
+                headId = other.headId;
+            }
+            /**
+             * return a new iterator which pointer n-next elements
+             *   even if there are not enough elements, just return the answer.
+             * as well as operator-
+             */
+            /**
+             * TODO iter++
+             */
+            iterator operator++(int) {
+                iterator tmp = *this;
+                if(p == nullptr || p->next == nullptr) throw invalid_iterator();
+                p = p->next;
+                return tmp;
+            }
+            /**
+             * TODO ++iter
+             */
+            iterator & operator++() {
+                if(p == nullptr || p->next == nullptr) throw invalid_iterator();
+                p = p->next;
+                return *this;
+            }
+            /**
+             * TODO iter--
+             */
+            iterator operator--(int) {
+                iterator tmp = *this;
+                if(p == nullptr || p->prev == nullptr || p->prev->prev == nullptr) throw invalid_iterator();
+                p = p->prev;
+                return tmp;
+            }
+            /**
+             * TODO --iter
+             */
+            iterator & operator--() {
+                if(p == nullptr || p->prev == nullptr || p->prev->prev == nullptr) throw invalid_iterator();
+                p = p->prev;
+                return *this;
+            }
+            /**
+             * a operator to check whether two iterators are same (pointing to the same memory).
+             */
+            value_type & operator*() const {
+                if(p == nullptr || isSentinel(p)) throw index_out_of_bound();
+                return dataOf(p);
+            }
+            bool operator==(const iterator &rhs) const {
+                return p == rhs.p && headId == rhs.headId;
+            }
+            bool operator==(const const_iterator &rhs) const {
+                return p == rhs.p && headId == rhs.headId;
+            }
+            /**
+             * some other operator for iterator.
+             */
+            bool operator!=(const iterator &rhs) const {
+                return p != rhs.p || headId != rhs.headId;
+            }
+            bool operator!=(const const_iterator &rhs) const {
+                return p != rhs.p || headId != rhs.headId;
+            }
+            
+            /**
+             * for the support of it->first.
+             * See <http://kelvinh.github.io/blog/2013/11/20/overloading-of-member-access-operator-dash-greater-than-symbol-in-cpp/> for help.
+             */
+            value_type* operator->() const {
+                if(p == nullptr || isSentinel(p)) throw invalid_iterator();
+                return &dataOf(p);
+            }
+        };
+        class const_iterator {
+            friend iterator;
+            friend treap;
+            // it should has similar member method as iterator.
+            //  and it should be able to construct from an iterator.
+        private:
+            // data members.
+            const node *p;
+            node *headId;
+        public:
+            const_iterator() {
+                // TODO
+                p = nullptr; headId = nullptr;
+            }
+            const_iterator(const const_iterator &other) {
+                // TODO
+                p = other.p; headId = other.headId;
+            }
+            const_iterator(const iterator &other) {
+                // TODO
+                p = other.p; headId = other.headId;
+            }
+            /**
+             * return a new iterator which pointer n-next elements
+             *   even if there are not enough elements, just return the answer.
+             * as well as operator-
+             */
+            /**
+             * TODO iter++
+             */
+            const_iterator operator++(int) {
+                const_iterator tmp = *this;
+                if(p == nullptr || p->next == nullptr) throw invalid_iterator();
+                p = p->next;
+                return tmp;
+            }
+            /**
+             * TODO ++iter
+             */
+            const_iterator & operator++() {
+                if(p == nullptr || p->next == nullptr) throw invalid_iterator();
+                p = p->next;
+                return *this;
+            }
+            /**
+             * TODO iter--
+             */
+            const_iterator operator--(int) {
+                const_iterator tmp = *this;
+                if(p == nullptr || p->prev == nullptr || p->prev->prev == nullptr) throw invalid_iterator();
+                p = p->prev;
+                return tmp;
+            }
+            /**
+             * TODO --iter
+             */
+            const_iterator & operator--() {
+                if(p == nullptr || p->prev == nullptr || p->prev->prev == nullptr) throw invalid_iterator();
+                p = p->prev;
+                return *this;
+            }
+            /**
+             * a operator to check whether two iterators are same (pointing to the same memory).
+             */
+            const value_type & operator*() const {
+                if(p == nullptr || isSentinel(p)) throw index_out_of_bound();
+                return dataOf(p);
+            }
+            bool operator==(const iterator &rhs) const { return p == rhs.p && headId == rhs.headId; }
+            bool operator==(const const_iterator &rhs) const { return p == rhs.p && headId == rhs.headId; }
+            /**
+             * some other operator for iterator.
+             */
+            bool operator!=(const iterator &rhs) const { return p != rhs.p || headId != rhs.headId; }
+            bool operator!=(const const_iterator &rhs) const { return p != rhs.p || headId != rhs.headId; }
+            
+            /**
+             * for the support of it->first.
+             * See <http://kelvinh.github.io/blog/2013/11/20/overloading-of-member-access-operator-dash-greater-than-symbol-in-cpp/> for help.
+             */
+            const value_type* operator->() const {
+                if(p == nullptr || isSentinel(p)) throw invalid_iterator();
+                return &dataOf(p);
+            }
+        };
+        /**
+         * TODO two constructors
+         */
+        treap(): treap(Compare()) {}
+        explicit treap(const Allocator &a): treap(Compare(), a) {}
+        explicit treap(const Compare &c, const Allocator &a = Allocator()): cmp(c), alloc(a), pool(nullptr), seed(12345) {
+            head = newSentinel();
+            tail = newSentinel();
+            
+            head->next = tail; tail->prev = head;
+            
+            root = nullptr;
+            elemSz = 0;
+        }
+        
+        /// the treap is cloned in O(n) with the same priorities, hence the same shape.
+        treap(const treap &other):
+        treap(other.cmp, alloc_traits::select_on_container_copy_construction(other.alloc)) {
+            cloneFrom(other);
+        }
+        /**
+         * build from [first, last), which should be sorted by key.
+         * a strictly increasing input is loaded in O(n) without any rotation;
+         * elements out of order are inserted normally, and duplicated keys
+         * are ignored like insert() does.
+         */
+        template<class InputIt>
+        treap(InputIt first, InputIt last, const Compare &c = Compare(), const Allocator &a = Allocator()): treap(c, a) {
+            node *spine = nullptr;
+            for(; first != last; ++first) {
+                const value_type &value = *first;
+                if(elemSz == 0 || (Multi ? !keyLess(Traits::key(value), keyOf(tail->prev)) :
+                                   keyLess(keyOf(tail->prev), Traits::key(value)))) {
+                    appendNode(newNode(rand1(), value), spine);
+                }
+                else {
+                    pullUp(spine);
+                    insert(value);
+                    spine = tail->prev;
+                }
+            }
+            pullUp(spine);
+        }
+        /// other is left empty.
+        treap(treap &&other): treap(other.cmp, other.alloc) { swap(other); }
+        /**
+         * TODO assignment operator
+         */
+        treap & operator=(const treap &other) {
+            if(&other == this) return *this;
+            clear();
+            /// sentinels must be given back to the allocator they come from.
+            if(alloc_traits::propagate_on_container_copy_assignment::value && alloc != other.alloc) {
+                deleteSentinel(head); deleteSentinel(tail);
+                alloc = other.alloc;
+                head = newSentinel();
+                tail = newSentinel();
+                head->next = tail; tail->prev = head;
+            }
+            cmp = other.cmp;
+            cloneFrom(other);
+            return *this;
+        }
+        treap & operator=(treap &&other) {
+            if(&other == this) return *this;
+            clear();
+            /// our nodes can be handed to other only if its allocator can free them.
+            if(alloc_traits::propagate_on_container_move_assignment::value || alloc == other.alloc) {
+                swapTree(other);
+                if(alloc_traits::propagate_on_container_move_assignment::value) {
+                    using std::swap;
+                    swap(alloc, other.alloc);
+                }
+            }
+            else {
+                cmp = other.cmp;
+                for(const_iterator citr = other.cbegin(); citr != other.cend(); ++citr)
+                    insert(*citr);
+                other.clear();
+            }
+            return *this;
+        }
+        /**
+         * exchanges the contents with other.
+         * allocators are swapped only if the allocator asks for it.
+         */
+        void swap(treap &other) {
+            swapTree(other);
+            if(alloc_traits::propagate_on_container_swap::value) {
+                using std::swap;
+                swap(alloc, other.alloc);
+            }
+        }
+        allocator_type get_allocator() const { return alloc; }
+        /**
+         * TODO Destructors
+         */
+        ~treap() { clear();
+            deleteSentinel(head); deleteSentinel(tail);
+        }
+        /**
+         * return a iterator to the beginning
+         */
+        iterator begin() { iterator itr; itr.p = head->next; itr.headId = head; return itr; }
+        const_iterator cbegin() const { const_iterator citr; citr.p = head->next; citr.headId = head; return citr; }
+        /**
+         * return a iterator to the end
+         * in fact, it returns past-the-end.
+         */
+        iterator end() { iterator itr; itr.p = tail; itr.headId = head; return itr; }
+        const_iterator cend() const { const_iterator citr; citr.p = tail; citr.headId = head; return citr; }
+        /**
+         * checks whether the container is empty
+         * return true if empty, otherwise false.
+         */
+        bool empty() const { return elemSz == 0; }
+        /**
+         * returns the number of elements.
+         */
+        size_t size() const { return elemSz; }
+        /**
+         * clears the contents
+         * values are destroyed along the linked list, unless they have
+         * trivial destructors, then the pool is released as a whole.
+         * if the pool is shared with maps split from this one, the slots
+         * are handed back one by one instead.
+         */
+        void clear() {
+            if(pool != nullptr && pool->refs.load(std::memory_order_acquire) > 1) {
+                for(node *ptr = head->next; ptr != tail; ) {
+                    node *nxt = ptr->next;
+                    deleteNode(ptr);
+                    ptr = nxt;
+                }
+            }
+            else if(!std::is_trivially_destructible<value_type>::value || !std::is_trivially_destructible<slot>::value) {
+                for(node *ptr = head->next; ptr != tail; ) {
+                    node *nxt = ptr->next;
+                    destroyNode(ptr);
+                    ptr = nxt;
+                }
+            }
+            dropPool();
+            root = nullptr;
+            head->next = tail; tail->prev = head;
+            elemSz = 0;
+        }
+        /**
+         * insert an element.
+         * return a pair, the first of the pair is
+         *   the iterator to the new element (or the element that prevented the insertion),
+         *   the second one is true if insert successfully, or false.
+         */
+        // first version of insert.
+        /**
+         pair<iterator, bool> insert(const value_type &value) {
+         pair<iterator, bool> ret;
+         if(root == nullptr) {
+         root = newNode(&value, rand1());
+         head->next = tail->prev = root;
+         root->next = tail; root->prev = head;
+         ++elemSz;
+         ret.first.p = root;
+         ret.second = true;
+         }
+         else {
+         ret = insert(root, value);
+         }
+         return ret;
+         }
+         */
+        /** Since I use parent field, I had better use find_insert function to
+         * find the place for val to be inserted, and rotate with the guidance of
+         * parent pointer. */
+        pair<iterator, bool> insert(const value_type &value) {
+            pair<iterator, bool> ret; ret.first.headId = head;
+            
+            int side;
+            node *iptr = find_insert(Traits::key(value), side);
+
+            if(iptr != nullptr && side == 0) {
+                ret.first.p = iptr; ret.second = false;
+                return ret;
+            }
+            ret.first.p = newNode(rand1(), value); ret.second = true;
+            link(iptr, side, ret.first.p);
+            return ret;
+        }
+        /**
+         * insert an element, moving the mapped value into the map.
+         */
+        pair<iterator, bool> insert(value_type &&value) {
+            pair<iterator, bool> ret; ret.first.headId = head;
+            int side;
+            node *iptr = find_insert(Traits::key(value), side);
+            if(iptr != nullptr && side == 0) {
+                ret.first.p = iptr; ret.second = false;
+                return ret;
+            }
+            ret.first.p = newNode(rand1(), std::move(value)); ret.second = true;
+            link(iptr, side, ret.first.p);
+            return ret;
+        }
+        /**
+         * construct a value_type from args right in a new node, and insert it.
+         * the value is built before the search since its key is needed;
+         * it is destroyed again if the key is present.
+         */
+        template<class... Args>
+        pair<iterator, bool> emplace(Args&&... args) {
+            pair<iterator, bool> ret; ret.first.headId = head;
+            node *x = newNode(rand1(), std::forward<Args>(args)...);
+            int side;
+            node *iptr = find_insert(keyOf(x), side);
+            if(iptr != nullptr && side == 0) {
+                deleteNode(x);
+                ret.first.p = iptr; ret.second = false;
+                return ret;
+            }
+            ret.first.p = x; ret.second = true;
+            link(iptr, side, x);
+            return ret;
+        }
+        /**
+         * insert value as close as possible before hint.
+         * if the key goes right between prev(hint) and hint, the node is hung
+         * there directly: under hint if it has no left son, otherwise under
+         * prev(hint), which then has no right son. no key is compared on the
+         * way down, so sorted input with hint end() costs O(1) comparisons.
+         * otherwise behave like insert(value).
+         */
+        iterator insert(const_iterator hint, const value_type &value) {
+            if(hint.headId != head) throw invalid_iterator();
+            iterator itr; itr.headId = head;
+            int side;
+            node *par = hint_place(const_cast<node *>(hint.p), Traits::key(value), side);
+            if(par != nullptr && side == 0) { itr.p = par; return itr; }
+            itr.p = newNode(rand1(), value);
+            link(par, side, itr.p);
+            return itr;
+        }
+        iterator insert(const_iterator hint, value_type &&value) {
+            if(hint.headId != head) throw invalid_iterator();
+            iterator itr; itr.headId = head;
+            int side;
+            node *par = hint_place(const_cast<node *>(hint.p), Traits::key(value), side);
+            if(par != nullptr && side == 0) { itr.p = par; return itr; }
+            itr.p = newNode(rand1(), std::move(value));
+            link(par, side, itr.p);
+            return itr;
+        }
+        /**
+         * construct a value_type from args right in a new node,
+         * and insert it as close as possible before hint.
+         */
+        template<class... Args>
+        iterator emplace_hint(const_iterator hint, Args&&... args) {
+            if(hint.headId != head) throw invalid_iterator();
+            iterator itr; itr.headId = head;
+            node *x = newNode(rand1(), std::forward<Args>(args)...);
+            int side;
+            node *par = hint_place(const_cast<node *>(hint.p), keyOf(x), side);
+            if(par != nullptr && side == 0) {
+                deleteNode(x);
+                itr.p = par;
+                return itr;
+            }
+            itr.p = x;
+            link(par, side, x);
+            return itr;
+        }
+        /**
+         * erase the element at pos.
+         *
+         * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
+         */
+        /** erase a node with one or no child is easy.
+         * erase a node with two children, I have to first rotate this node to previous two cases.
+         * but first, I have to find the node.
+         *
+         * if root is erased, care must be taken.
+         * */
+        void erase(iterator pos) {
+            if(pos.headId != head) throw invalid_iterator();
+            if(pos.p == head || pos.p == tail || pos.p == nullptr) throw index_out_of_bound();
+            
+            node *ptr = pos.p;
+            /**
+             /// adjust the node to erase so that it has fewer then 2 sons.
+             while(ptr->lson && ptr->rson) {
+             /// high priority goes up.
+             if(ptr->lson->priority > ptr->rson->priority) r_rt(ptr);
+             else l_rt(ptr);
+             }
+             
+             if(!ptr->lson && !ptr->rson) {
+             if(ptr == root) {
+             delete ptr; --elemSz;
+             head->next = tail->prev = nullptr;
+             }
+             else {
+             /// parent
+             if(ptr == ptr->parent->lson) ptr->parent->lson = nullptr;
+             else ptr->parent->rson = nullptr;
+             /// linked list
+             ptr->prev->next = ptr->next;
+             ptr->next->prev = ptr->prev;
+             /// delete
+             delete ptr; --elemSz;
+             }
+             }
+             else if(ptr->lson && !ptr->rson) {
+             if(ptr == root) {
+             root = ptr->lson;
+             }
+             } */
+            
+            /// keep rotating until have no child.
+            while(ptr->lson || ptr->rson) {
+                if(ptr->rson && ptr->lson) {
+                    if(ptr->lson->priority > ptr->rson->priority) {
+                        if(ptr == root) root = r_rt(ptr);
+                        else r_rt(ptr);
+                    }
+                    else {
+                        if(ptr == root) root = l_rt(ptr);
+                        else l_rt(ptr);
+                    }
+                }
+                else if(ptr->lson && !ptr->rson) {
+                    if(ptr == root) root = ptr->lson;
+                    r_rt(ptr);
+                }
+                else {
+                    if(ptr == root) root = ptr->rson;
+                    l_rt(ptr);
+                }
+            }
+            
+            if(ptr == root) {
+                deleteNode(ptr); --elemSz;
+                head->next = tail; tail->prev = head;
+                root = nullptr;
+            }
+            else {
+                /// parent
+                if (ptr == ptr->parent->lson) ptr->parent->lson = nullptr;
+                else ptr->parent->rson = nullptr;
+                if(augmented) pullUp(ptr->parent);
+                else for(node *anc = ptr->parent; anc != nullptr; anc = anc->parent) --anc->size;
+                /// linked list
+                ptr->prev->next = ptr->next;
+                ptr->next->prev = ptr->prev;
+                /// delete
+                deleteNode(ptr);
+                --elemSz;
+            }
+        }
+        /**
+         * erase the elements in [first, last).
+         * the range is cut out of the treap by two splits and one merge in
+         * O(log n), then its elements are destroyed.
+         *
+         * throw invalid_iterator if first or last doesn't belong to this map,
+         * or if first comes after last.
+         */
+        void erase(iterator first, iterator last) {
+            if(first.headId != head || last.headId != head) throw invalid_iterator();
+            if(first.p == nullptr || last.p == nullptr || first.p == head || last.p == head) throw invalid_iterator();
+            if(first == last) return;
+            /// cut by position, not by key, which may not tell equal keys apart.
+            size_t lo = indexOf(first.p), hi = indexOf(last.p);
+            if(hi < lo) throw invalid_iterator();
+            
+            node *lower, *mid, *upper;
+            splitAt(root, lo, lower, mid);
+            splitAt(mid, hi - lo, mid, upper);
+            root = mergeTree(lower, upper);
+            elemSz -= sizeOf(mid);
+            /// the range is still linked from first to last->prev.
+            first.p->prev->next = last.p;
+            last.p->prev = first.p->prev;
+            for(node *ptr = first.p; ptr != last.p; ) {
+                node *nxt = ptr->next;
+                deleteNode(ptr);
+                ptr = nxt;
+            }
+        }
+        /**
+         * Returns the number of elements with key
+         *   that compares equivalent to the specified argument,
+         *   which is either 1 or 0
+         *     unless Multi allows duplicates, then it takes two ranks, O(log n).
+         * The default method of check the equivalence is !(a < b || b > a)
+         */
+        size_t count(const Key &key) const {
+            if(Multi) return countBefore(key, true) - countBefore(key, false);
+            node *ptr = find_erase(key);
+            if(ptr) return 1; else return 0;
+        }
+        /**
+         * erase the elements with key, return the number of elements erased.
+         */
+        size_t erase(const Key &key) {
+            if(Multi) {
+                size_t n = count(key);
+                if(n != 0) erase(lower_bound(key), upper_bound(key));
+                return n;
+            }
+            node *ptr = find_erase(key);
+            if(ptr == nullptr) return 0;
+            iterator itr; itr.p = ptr; itr.headId = head;
+            erase(itr);
+            return 1;
+        }
+        /**
+         * Finds an element with key equivalent to key.
+         * key value of the element to search for.
+         * Iterator to an element with key equivalent to key.
+         *   If no such element is found, past-the-end (see end()) iterator is returned.
+         */
+        iterator find(const Key &key) {
+            node *ptr = find_erase(key);
+            if(ptr) {
+                iterator itr; itr.p = ptr; itr.headId = head; return itr;
+            }
+            else return end();
+        }
+        const_iterator find(const Key &key) const {
+            node *ptr = find_erase(key);
+            if(ptr) {
+                const_iterator citr; citr.p = ptr; citr.headId = head; return citr;
+            }
+            else return cend();
+        }
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        size_t count(const K &key) const {
+            if(Multi) return countBefore(key, true) - countBefore(key, false);
+            return find_erase(key) ? 1 : 0;
+        }
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        iterator find(const K &key) {
+            node *ptr = find_erase(key);
+            if(ptr) {
+                iterator itr; itr.p = ptr; itr.headId = head; return itr;
+            }
+            else return end();
+        }
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        const_iterator find(const K &key) const {
+            node *ptr = find_erase(key);
+            if(ptr) {
+                const_iterator citr; citr.p = ptr; citr.headId = head; return citr;
+            }
+            else return cend();
+        }
+        /**
+         * look up keys[0 .. n) at once, out[i] = find(keys[i]).
+         * a single find waits for every node it visits to come from memory.
+         * here up to findLanes keys go down the tree together, round robin:
+         * each lane takes one step and prefetches its next node, so by the
+         * time it comes around again the node has arrived, and the misses
+         * of all lanes overlap. a finished lane takes the next key.
+         */
+        void find_many(const Key *keys, size_t n, iterator *out) {
+            findMany(keys, n, out);
+        }
+        void find_many(const Key *keys, size_t n, const_iterator *out) const {
+            findMany(keys, n, out);
+        }
+
+        /**
+         * returns an iterator to the element with index k in key order, counting from 0.
+         * throw index_out_of_bound if k >= size().
+         */
+        iterator nth(size_t k) {
+            if(k >= elemSz) throw index_out_of_bound();
+            iterator itr; itr.p = kth(k); itr.headId = head; return itr;
+        }
+        const_iterator nth(size_t k) const {
+            if(k >= elemSz) throw index_out_of_bound();
+            const_iterator citr; citr.p = kth(k); citr.headId = head; return citr;
+        }
+        /**
+         * returns the number of elements with key less than key.
+         */
+        size_t rank(const Key &key) const { return countBefore(key, false); }
+        /**
+         * returns the number of elements with key in [lo, hi).
+         */
+        size_t count_range(const Key &lo, const Key &hi) const {
+            if(!keyLess(lo, hi)) return 0;
+            return rank(hi) - rank(lo);
+        }
+        /**
+         * returns the aggregate of the elements with key in [lo, hi), combined
+         * in key order, or identity() if there is none. O(log n).
+         * the map needs a Monoid other than no_aggregate.
+         */
+        aggregate_type aggregate(const Key &lo, const Key &hi) const {
+            /// go down to the top node in range, where the paths to lo and hi part.
+            node *top = root;
+            while(top != nullptr) {
+                if(keyLess(keyOf(top), lo)) top = top->rson;
+                else if(!keyLess(keyOf(top), hi)) top = top->lson;
+                else break;
+            }
+            if(top == nullptr) return mono.identity();
+            /// keys not less than lo in the left subtree, found from right to left.
+            aggregate_type left = mono.identity();
+            for(node *ptr = top->lson; ptr != nullptr; ) {
+                if(keyLess(keyOf(ptr), lo)) ptr = ptr->rson;
+                else {
+                    left = mono.combine(mono.combine(liftOf(ptr), aggOf(ptr->rson)), left);
+                    ptr = ptr->lson;
+                }
+            }
+            /// keys less than hi in the right subtree, found from left to right.
+            aggregate_type right = mono.identity();
+            for(node *ptr = top->rson; ptr != nullptr; ) {
+                if(!keyLess(keyOf(ptr), hi)) ptr = ptr->lson;
+                else {
+                    right = mono.combine(right, mono.combine(aggOf(ptr->lson), liftOf(ptr)));
+                    ptr = ptr->rson;
+                }
+            }
+            return mono.combine(mono.combine(left, liftOf(top)), right);
+        }
+        /// the aggregate of all elements, O(1).
+        aggregate_type aggregate() const { return aggOf(root); }
+        /**
+         * bring the aggregates up to date after the mapped value of pos
+         * was changed through an iterator or operator[]. O(log n).
+         * throw invalid_iterator if pos is end() or doesn't belong to this map.
+         */
+        void refresh(const_iterator pos) {
+            if(pos.headId != head || pos.p == nullptr || isSentinel(pos.p)) throw invalid_iterator();
+            pullUp(const_cast<node *>(pos.p));
+        }
+        
+        /**
+         * returns an iterator to the first element with key not less than key,
+         * or end() if there is none.
+         */
+        iterator lower_bound(const Key &key) {
+            iterator itr; itr.p = lowerNode(key); itr.headId = head; return itr;
+        }
+        const_iterator lower_bound(const Key &key) const {
+            const_iterator citr; citr.p = lowerNode(key); citr.headId = head; return citr;
+        }
+        /**
+         * returns an iterator to the first element with key greater than key,
+         * or end() if there is none.
+         */
+        iterator upper_bound(const Key &key) {
+            iterator itr; itr.p = upperNode(key); itr.headId = head; return itr;
+        }
+        const_iterator upper_bound(const Key &key) const {
+            const_iterator citr; citr.p = upperNode(key); citr.headId = head; return citr;
+        }
+        /**
+         * returns the range of elements with key equivalent to key,
+         * as the pair lower_bound(key), upper_bound(key).
+         */
+        pair<iterator, iterator> equal_range(const Key &key) {
+            return pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+        }
+        pair<const_iterator, const_iterator> equal_range(const Key &key) const {
+            return pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+        }
+        /**
+         * calls f(value) for every element with key in [lo, hi), in key order.
+         * the walk follows the linked list from lower_bound(lo) without
+         * building iterators, so f must not insert into or erase from this map.
+         */
+        template<class F>
+        void for_each_in_range(const Key &lo, const Key &hi, F f) {
+            for(node *ptr = lowerNode(lo); ptr != tail && keyLess(keyOf(ptr), hi); ptr = ptr->next)
+                f(dataOf(ptr));
+        }
+        template<class F>
+        void for_each_in_range(const Key &lo, const Key &hi, F f) const {
+            for(const node *ptr = lowerNode(lo); ptr != tail && keyLess(keyOf(ptr), hi); ptr = ptr->next)
+                f(dataOf(ptr));
+        }
+        
+        /**
+         * move all the elements of other into this map.
+         * if every key of other is greater than every key of this map, or
+         * every key less, the two treaps are merged in O(log n) and nothing
+         * is copied. otherwise, or if the allocators differ, the elements are
+         * inserted one by one, and those with a key already in this map are
+         * left in other.
+         */
+        void join(treap &&other) {
+            if(&other == this || other.empty()) return;
+            if(!disjointWith(other) || !canAdopt(other)) {
+                for(node *ptr = other.head->next; ptr != other.tail; ) {
+                    node *nxt = ptr->next;
+                    if(insert(dataOf(ptr)).second) {
+                        iterator itr; itr.p = ptr; itr.headId = other.head;
+                        other.erase(itr);
+                    }
+                    ptr = nxt;
+                }
+                return;
+            }
+            
+            if(pool == nullptr) { pool = other.pool; pool->refs.fetch_add(1, std::memory_order_relaxed); }
+            else if(pool != other.pool) pool->absorb(*other.pool);
+            
+            /// make this map the lower one.
+            if(!empty() && keyLess(keyOf(other.tail->prev), keyOf(head->next))) {
+                std::swap(root, other.root);
+                std::swap(elemSz, other.elemSz);
+                node *first = head->next, *last = tail->prev;
+                head->next = other.head->next; head->next->prev = head;
+                tail->prev = other.tail->prev; tail->prev->next = tail;
+                other.head->next = first; first->prev = other.head;
+                other.tail->prev = last; last->next = other.tail;
+            }
+            
+            node *first = other.head->next, *last = other.tail->prev;
+            tail->prev->next = first; first->prev = tail->prev;
+            last->next = tail; tail->prev = last;
+            root = mergeTree(root, other.root);
+            elemSz += other.elemSz;
+            
+            other.root = nullptr;
+            other.head->next = other.tail; other.tail->prev = other.head;
+            other.elemSz = 0;
+            other.dropPool();
+        }
+        /**
+         * move all the elements of other into this map. for a key in both
+         * maps, resolve(mine, theirs) is called with the two mapped values,
+         * and mine is kept. the default keeps the value of this map.
+         *
+         * the treaps are merged by splitting one at the root of the other,
+         * O(m log(n/m + 1)) for sizes m <= n, so a small other costs about
+         * its own size. nothing is copied; if the allocators differ, or
+         * other shares its pool with a third map, the elements are moved
+         * over one by one instead. other is left empty.
+         */
+        template<class Resolve>
+        void merge_union(treap &&other, Resolve resolve) {
+            static_assert(!Multi, "set operations need unique keys");
+            if(&other == this || other.empty()) return;
+            if(!canAdopt(other)) {
+                for(node *ptr = other.head->next; ptr != other.tail; ptr = ptr->next) {
+                    iterator itr = find(keyOf(ptr));
+                    if(itr != end()) resolve(Traits::mapped(*itr), Traits::mapped(dataOf(ptr)));
+                    else insert(std::move(dataOf(ptr)));
+                }
+                other.clear();
+                return;
+            }
+            if(disjointWith(other)) { join(std::move(other)); return; }
+            
+            if(pool != other.pool) pool->absorb(*other.pool);
+            span mine = {root, head->next, tail->prev}, theirs = {other.root, other.head->next, other.tail->prev};
+            span ret = unionTree(mine, theirs, true, resolve);
+            root = ret.root; root->parent = nullptr;
+            head->next = ret.first; ret.first->prev = head;
+            tail->prev = ret.last; ret.last->next = tail;
+            elemSz = root->size;
+            
+            other.root = nullptr;
+            other.head->next = other.tail; other.tail->prev = other.head;
+            other.elemSz = 0;
+            other.dropPool();
+        }
+        void merge_union(treap &&other) { merge_union(std::move(other), keep_mine()); }
+        /**
+         * keep only the elements whose key is also in other. resolve(mine, theirs)
+         * is called for every element kept, with theirs from other.
+         * O(m log(n/m + 1)) plus the elements erased.
+         */
+        template<class Resolve>
+        void intersect(const treap &other, Resolve resolve) {
+            static_assert(!Multi, "set operations need unique keys");
+            if(&other == this) return;
+            root = filterTree<true>(root, other.root, resolve);
+            if(root != nullptr) root->parent = nullptr;
+        }
+        void intersect(const treap &other) { intersect(other, keep_mine()); }
+        /**
+         * erase the elements whose key is in other.
+         * O(m log(n/m + 1)) for sizes m <= n.
+         */
+        void subtract(const treap &other) {
+            static_assert(!Multi, "set operations need unique keys");
+            if(&other == this) { clear(); return; }
+            keep_mine none;
+            root = filterTree<false>(root, other.root, none);
+            if(root != nullptr) root->parent = nullptr;
+        }
+        
+        int height() { return height(root); }
+    protected:
+        /** return a node for value to be inserted.
+         * if map is empty, return nullptr.
+         * if duplicated key, return the node with duplicated key.
+         * else I can directly insert onto that node.
+         * with Multi there are no duplicates, equal keys go right. */
+        /// side is set to 0 for a duplicated key, -1 or 1 if key goes to the left or right son.
+        node *find_insert(const Key &key, int &side) const { return find_insert(key, side, threeWay()); }
+        /** one comparison per level: the last node we went right from is the
+         * greatest key not after key, only it can be a duplicate. */
+        node *find_insert(const Key &key, int &side, std::false_type) const {
+            node *ptr = root, *par = nullptr, *cand = nullptr;
+            side = 0;
+            while(ptr != nullptr) {
+                par = ptr;
+                if(cmp(key, keyOf(ptr))) { side = -1; ptr = ptr->lson; }
+                else { side = 1; cand = ptr; ptr = ptr->rson; }
+            }
+            if(!Multi && cand != nullptr && !cmp(keyOf(cand), key)) { side = 0; return cand; }
+            return par;
+        }
+        node *find_insert(const Key &key, int &side, std::true_type) const {
+            node *ptr = root, *par = nullptr;
+            side = 0;
+            while(ptr != nullptr) {
+                par = ptr;
+                int c = cmp(key, keyOf(ptr));
+                if(c == 0 && !Multi) { side = 0; return ptr; }
+                side = c < 0 ? -1 : 1;
+                ptr = c < 0 ? ptr->lson : ptr->rson;
+            }
+            return par;
+        }
+
+        /** the new node x is hung under par on side, or becomes the root if
+         * par is nullptr. then it is rotated up along its parents. */
+        void link(node *par, int side, node *x) {
+            ++elemSz;
+            pull(x);
+            if(par == nullptr) {
+                root = x;
+                head->next = tail->prev = root;
+                root->prev = head; root->next = tail;
+                return;
+            }
+            x->parent = par;
+            /// maintain linked list.
+            if(side < 0) {
+                par->lson = x;
+                x->prev = par->prev; x->next = par;
+                par->prev->next = x; par->prev = x;
+            }
+            else {
+                par->rson = x;
+                x->next = par->next; x->prev = par;
+                par->next->prev = x; par->next = x;
+            }
+            /// every ancestor gains one node in its subtree.
+            if(augmented) pullUp(par);
+            else for(node *ptr = par; ptr != nullptr; ptr = ptr->parent) ++ptr->size;
+            /** backTrack to rotate, be careful that root may be changed. */
+            while(x->parent && x->priority > x->parent->priority) {
+                if(x == x->parent->lson) {
+                    if(x->parent == root) root = x;
+                    x = r_rt(x->parent);
+                }
+                else {
+                    if(x->parent == root) root = x;
+                    x = l_rt(x->parent);
+                }
+            }
+        }
+        /** check whether key goes right before the node p, which may be tail.
+         * if so, return where to hang it like find_insert, or nullptr with side
+         * 1 for an empty map. if p or its predecessor holds key, return that
+         * node with side 0, unless Multi. otherwise return nullptr with side 0. */
+        node *hint_insert(node *p, const Key &key, int &side) const {
+            side = 0;
+            node *pre = p->prev;
+            if(p != tail) {
+                if(keyLess(keyOf(p), key)) return nullptr;
+                if(!Multi && !keyLess(key, keyOf(p))) return p;
+            }
+            if(pre != head) {
+                if(keyLess(key, keyOf(pre))) return nullptr;
+                if(!Multi && !keyLess(keyOf(pre), key)) return pre;
+            }
+            if(root == nullptr) { side = 1; return nullptr; }
+            if(p != tail && p->lson == nullptr) { side = -1; return p; }
+            side = 1;
+            return pre;
+        }
+        
+        /// like find_insert, but try the position right before the node p first.
+        node *hint_place(node *p, const Key &key, int &side) const {
+            node *par = hint_insert(p, key, side);
+            if(par == nullptr && side == 0) par = find_insert(key, side);
+            return par;
+        }
+        template<class K, class... Args>
+        pair<iterator, bool> tryEmplace(K &&key, Args&&... args) {
+            pair<iterator, bool> ret; ret.first.headId = head;
+            int side;
+            node *iptr = find_insert(key, side);
+            if(iptr != nullptr && side == 0) {
+                ret.first.p = iptr; ret.second = false;
+                return ret;
+            }
+            ret.first.p = newNodePiecewise(rand1(), std::forward<K>(key), std::forward<Args>(args)...);
+            ret.second = true;
+            link(iptr, side, ret.first.p);
+            return ret;
+        }
+        
+        /// the number of elements with key before key, or not after it if orEqual.
+        template<class K>
+        size_t countBefore(const K &key, bool orEqual) const {
+            size_t ret = 0;
+            node *ptr = root;
+            while(ptr != nullptr) {
+                if(orEqual ? !keyLess(key, keyOf(ptr)) : keyLess(keyOf(ptr), key)) {
+                    ret += sizeOf(ptr->lson) + 1;
+                    ptr = ptr->rson;
+                }
+                else ptr = ptr->lson;
+            }
+            return ret;
+        }
+        /// the first node whose key is not before key, tail if there is none.
+        node *lowerNode(const Key &key) const {
+            node *ptr = root, *ret = tail;
+            while(ptr != nullptr) {
+                if(keyLess(keyOf(ptr), key)) ptr = ptr->rson;
+                else { ret = ptr; ptr = ptr->lson; }
+            }
+            return ret;
+        }
+        /// the first node whose key is after key, tail if there is none.
+        node *upperNode(const Key &key) const {
+            node *ptr = root, *ret = tail;
+            while(ptr != nullptr) {
+                if(keyLess(key, keyOf(ptr))) { ret = ptr; ptr = ptr->lson; }
+                else ptr = ptr->rson;
+            }
+            return ret;
+        }
+        
+        /** return a node pointer with the same key equal to parameter key.
+         * return nullptr if not exist.
+         * K is Key, or any type a transparent comparator takes. */
+        template<class K>
+        node *find_erase(const K &key) const { return find_erase(key, threeWay()); }
+        /** one comparison per level: keep the last node not before key,
+         * and test it for equality once at the bottom. */
+        template<class K>
+        node *find_erase(const K &key, std::false_type) const {
+            node *ptr = root, *cand = nullptr;
+            while(ptr != nullptr) {
+                if(cmp(keyOf(ptr), key)) ptr = ptr->rson;
+                else { cand = ptr; ptr = ptr->lson; }
+            }
+            if(cand != nullptr && !cmp(key, keyOf(cand))) return cand;
+            return nullptr;
+        }
+        template<class K>
+        node *find_erase(const K &key, std::true_type) const {
+            node *ptr = root;
+            while(ptr != nullptr) {
+                int c = cmp(key, keyOf(ptr));
+                if(c == 0) return ptr;
+                ptr = c < 0 ? ptr->lson : ptr->rson;
+            }
+            return nullptr;
+        }
+
+        /// hint the cache to load p and its value, nothing off GCC and Clang.
+        static void prefetch(const node *p) {
+#if defined(__GNUC__)
+            __builtin_prefetch(p);
+            __builtin_prefetch(&dataOf(p));
+#endif
+        }
+        static const size_t findLanes = 16;
+        /** the batched find_erase behind find_many, a lane runs the same
+         * descent with one comparison per level. */
+        template<class Itr>
+        void findMany(const Key *keys, size_t n, Itr *out) const {
+            struct lane { size_t idx; node *ptr, *cand; };
+            lane lanes[findLanes];
+            size_t next = 0, active = 0;
+            for(; active < findLanes && next < n; ++active, ++next) {
+                lanes[active].idx = next; lanes[active].ptr = root; lanes[active].cand = nullptr;
+            }
+            if(root != nullptr) prefetch(root);
+            while(active > 0) {
+                for(size_t i = 0; i < active; ) {
+                    lane &l = lanes[i];
+                    if(l.ptr != nullptr) {
+                        if(keyLess(keyOf(l.ptr), keys[l.idx])) l.ptr = l.ptr->rson;
+                        else { l.cand = l.ptr; l.ptr = l.ptr->lson; }
+                        if(l.ptr != nullptr) prefetch(l.ptr);
+                        ++i;
+                        continue;
+                    }
+                    out[l.idx].headId = head;
+                    if(l.cand != nullptr && !keyLess(keys[l.idx], keyOf(l.cand))) out[l.idx].p = l.cand;
+                    else out[l.idx].p = tail;
+                    if(next < n) { l.idx = next++; l.ptr = root; l.cand = nullptr; ++i; }
+                    /// no key left, the last lane fills the hole.
+                    else l = lanes[--active];
+                }
+            }
+        }
+
+        /// rotations, then the two nodes that moved get their sizes.
+        node *r_rt(node *p) {
+            node *nt = treap_rotate_right(p);
+            pull(p); pull(nt);
+            return nt;
+        }
+        node *l_rt(node *p) {
+            node *nt = treap_rotate_left(p);
+            pull(p); pull(nt);
+            return nt;
+        }
+        
+        static node *leftmost(node *p) {
+            while(p->lson != nullptr) p = p->lson;
+            return p;
+        }
+        /// recompute subtree sizes from p up to the root.
+        void pullUp(node *p) const {
+            for(; p != nullptr; p = p->parent) pull(p);
+        }
+        
+        /** move the elements with key not less than key into ret, which must
+         * be empty. nodes are relinked in O(log n), nothing is copied; the
+         * two maps share the node pool from now on. */
+        void splitInto(const Key &key, treap &ret) {
+            node *upper;
+            splitTree(root, key, root, upper);
+            if(upper == nullptr) return;
+            
+            node *first = leftmost(upper), *last = tail->prev;
+            /// cut the linked list between the two halves.
+            first->prev->next = tail; tail->prev = first->prev;
+            ret.head->next = first; first->prev = ret.head;
+            ret.tail->prev = last; last->next = ret.tail;
+            
+            ret.root = upper;
+            ret.elemSz = upper->size;
+            elemSz -= upper->size;
+            ret.pool = pool; pool->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        /** split the treap t into lower, with keys less than key, and upper.
+         * walk down the search path once, hanging every node on the right
+         * spine of lower or the left spine of upper.
+         * the linked list is not touched. */
+        void splitTree(node *t, const Key &key, node *&lower, node *&upper) {
+            node *lroot = nullptr, *rroot = nullptr;
+            node **lhole = &lroot, **rhole = &rroot;
+            node *lpar = nullptr, *rpar = nullptr;
+            while(t != nullptr) {
+                if(keyLess(keyOf(t), key)) {
+                    *lhole = t; t->parent = lpar; lpar = t;
+                    lhole = &t->rson; t = t->rson;
+                }
+                else {
+                    *rhole = t; t->parent = rpar; rpar = t;
+                    rhole = &t->lson; t = t->lson;
+                }
+            }
+            *lhole = nullptr; *rhole = nullptr;
+            pullUp(lpar); pullUp(rpar);
+            lower = lroot; upper = rroot;
+        }
+        
+        /// like splitTree, but lower gets the first k nodes of t.
+        void splitAt(node *t, size_t k, node *&lower, node *&upper) {
+            node *lroot = nullptr, *rroot = nullptr;
+            node **lhole = &lroot, **rhole = &rroot;
+            node *lpar = nullptr, *rpar = nullptr;
+            while(t != nullptr) {
+                if(sizeOf(t->lson) < k) {
+                    k -= sizeOf(t->lson) + 1;
+                    *lhole = t; t->parent = lpar; lpar = t;
+                    lhole = &t->rson; t = t->rson;
+                }
+                else {
+                    *rhole = t; t->parent = rpar; rpar = t;
+                    rhole = &t->lson; t = t->lson;
+                }
+            }
+            *lhole = nullptr; *rhole = nullptr;
+            pullUp(lpar); pullUp(rpar);
+            lower = lroot; upper = rroot;
+        }
+        
+        /** merge two treaps, every key of a is less than every key of b.
+         * walk down the right spine of a and the left spine of b together.
+         * the linked list is not touched. */
+        node *mergeTree(node *a, node *b) {
+            node *ret = nullptr, **hole = &ret, *par = nullptr;
+            while(a != nullptr && b != nullptr) {
+                if(a->priority > b->priority) {
+                    *hole = a; a->parent = par; par = a;
+                    hole = &a->rson; a = a->rson;
+                }
+                else {
+                    *hole = b; b->parent = par; par = b;
+                    hole = &b->lson; b = b->lson;
+                }
+            }
+            *hole = a != nullptr ? a : b;
+            if(*hole != nullptr) (*hole)->parent = par;
+            pullUp(par);
+            return ret;
+        }
+        
+        /** split t like splitTree, but the node with key, if any, goes to
+         * neither side and is returned without sons. lowerLast gets the
+         * greatest node of lower and upperFirst the least of upper. */
+        node *splitOut(node *t, const Key &key, node *&lower, node *&upper, node *&lowerLast, node *&upperFirst) {
+            node *lroot = nullptr, *rroot = nullptr;
+            node **lhole = &lroot, **rhole = &rroot;
+            node *lpar = nullptr, *rpar = nullptr, *mid = nullptr;
+            while(t != nullptr) {
+                if(keyLess(keyOf(t), key)) {
+                    *lhole = t; t->parent = lpar; lpar = t;
+                    lhole = &t->rson; t = t->rson;
+                }
+                else if(keyLess(key, keyOf(t))) {
+                    *rhole = t; t->parent = rpar; rpar = t;
+                    rhole = &t->lson; t = t->lson;
+                }
+                else { mid = t; break; }
+            }
+            lowerLast = lpar; upperFirst = rpar;
+            *lhole = *rhole = nullptr;
+            if(mid != nullptr) {
+                /// the sons of mid are the last pieces of the two sides.
+                if(mid->lson) { *lhole = mid->lson; mid->lson->parent = lpar; lowerLast = mid->prev; }
+                if(mid->rson) { *rhole = mid->rson; mid->rson->parent = rpar; upperFirst = mid->next; }
+                mid->lson = mid->rson = nullptr;
+                pull(mid);
+            }
+            pullUp(lpar); pullUp(rpar);
+            lower = lroot; upper = rroot;
+            return mid;
+        }
+        
+        /// a treap with its least and greatest node.
+        struct span { node *root, *first, *last; };
+        /// the default conflict policy of the set operations.
+        struct keep_mine {
+            template<class A, class B>
+            void operator()(A &, const B &) const {}
+        };
+        
+        /** the union of a and b, made of their nodes, where a comes from this map
+         * if aMine. the root with the higher priority stays on top, the other
+         * treap is split at its key, and the two halves are merged recursively.
+         *
+         * the linked list is rebuilt along the way: a node that has not been
+         * on top yet still has its links from its own map, which bound its
+         * subtrees. once both halves are merged it is linked to their ends. */
+        template<class Resolve>
+        span unionTree(span a, span b, bool aMine, Resolve &resolve) {
+            if(a.root == nullptr) return b;
+            if(b.root == nullptr) return a;
+            if(a.root->priority < b.root->priority) { std::swap(a, b); aMine = !aMine; }
+            node *top = a.root;
+            span al = {top->lson, a.first, top->prev}, ar = {top->rson, top->next, a.last};
+            span bl, br;
+            node *dup = splitOut(b.root, keyOf(top), bl.root, br.root, bl.last, br.first);
+            bl.first = b.first; br.last = b.last;
+            if(dup != nullptr) {
+                /// the node of this map survives, in the place of top.
+                if(aMine) resolve(Traits::mapped(dataOf(top)), Traits::mapped(dataOf(dup)));
+                else {
+                    resolve(Traits::mapped(dataOf(dup)), Traits::mapped(dataOf(top)));
+                    dup->priority = top->priority;
+                    std::swap(top, dup);
+                }
+                deleteNode(dup);
+            }
+            span l = unionTree(al, bl, aMine, resolve), r = unionTree(ar, br, aMine, resolve);
+            span ret = {top, top, top};
+            top->lson = l.root; top->rson = r.root;
+            if(l.root) { l.root->parent = top; l.last->next = top; top->prev = l.last; ret.first = l.first; }
+            if(r.root) { r.root->parent = top; r.first->prev = top; top->next = r.first; ret.last = r.last; }
+            pull(top);
+            return ret;
+        }
+        /** the nodes of t with a key in the treap o if Keep, or without one
+         * otherwise; the others are erased. t is split at the root of o,
+         * and its halves are filtered by the sons of o. */
+        template<bool Keep, class Resolve>
+        node *filterTree(node *t, const node *o, Resolve &resolve) {
+            if(t == nullptr) return nullptr;
+            if(o == nullptr) {
+                if(!Keep) return t;
+                eraseTree(t);
+                return nullptr;
+            }
+            node *l, *r, *lowerLast, *upperFirst;
+            node *mid = splitOut(t, keyOf(o), l, r, lowerLast, upperFirst);
+            l = filterTree<Keep>(l, o->lson, resolve);
+            r = filterTree<Keep>(r, o->rson, resolve);
+            if(mid != nullptr && !Keep) { unlinkNode(mid); mid = nullptr; }
+            if(mid == nullptr) return mergeTree(l, r);
+            resolve(Traits::mapped(dataOf(mid)), Traits::mapped(dataOf(o)));
+            pull(mid);
+            return mergeTree(mergeTree(l, mid), r);
+        }
+        /// take x out of the linked list and free it, the treap is not touched.
+        void unlinkNode(node *x) {
+            x->prev->next = x->next; x->next->prev = x->prev;
+            deleteNode(x); --elemSz;
+        }
+        /// free the whole subtree t like unlinkNode.
+        void eraseTree(node *t) {
+            while(t != nullptr) {
+                eraseTree(t->lson);
+                node *r = t->rson;
+                unlinkNode(t);
+                t = r;
+            }
+        }
+        /// whether the keys of this map and other don't interleave.
+        bool disjointWith(const treap &other) const {
+            return empty() || other.empty() ||
+                keyLess(keyOf(tail->prev), keyOf(other.head->next)) ||
+                keyLess(keyOf(other.tail->prev), keyOf(head->next));
+        }
+        /// whether the nodes of other can be taken over, i.e. live in our pool.
+        bool canAdopt(const treap &other) const {
+            return (pool == other.pool || pool == nullptr || other.pool->refs.load(std::memory_order_acquire) == 1) && alloc == other.alloc;
+        }
+        
+        /** append x, whose key is greater than every key, at the right end.
+         * spine is the rightmost node, and walks up the right spine like the
+         * stack of a Cartesian tree build. nodes leaving the spine are final
+         * and get their sizes, the rest waits for pullUp(spine).
+         * O(1) amortized, no key is compared. */
+        void appendNode(node *x, node *&spine) {
+            node *popped = nullptr;
+            while(spine != nullptr && spine->priority < x->priority) {
+                pull(spine);
+                popped = spine; spine = spine->parent;
+            }
+            x->lson = popped;
+            if(popped) popped->parent = x;
+            x->parent = spine;
+            if(spine) spine->rson = x; else root = x;
+            /// maintain linked list.
+            x->prev = tail->prev; x->next = tail;
+            tail->prev->next = x; tail->prev = x;
+            ++elemSz;
+            spine = x;
+        }
+        /** copy the nodes of other in order with their priorities,
+         * which gives the same treap in O(n). this map must be empty. */
+        void cloneFrom(const treap &other) {
+            node *spine = nullptr;
+            for(node *ptr = other.head->next; ptr != other.tail; ptr = ptr->next)
+                appendNode(newNode(ptr->priority, dataOf(ptr)), spine);
+            pullUp(spine);
+        }
+        
+        /** the index of the node p in key order, elemSz for tail.
+         * every time p is a right son, its parent and the parent's left
+         * subtree come before it. */
+        size_t indexOf(const node *p) const {
+            if(p == tail) return elemSz;
+            size_t ret = sizeOf(p->lson);
+            for(; p->parent != nullptr; p = p->parent)
+                if(p == p->parent->rson) ret += sizeOf(p->parent->lson) + 1;
+            return ret;
+        }
+        /** the node with index k, k must be less than elemSz. */
+        node *kth(size_t k) const {
+            node *ptr = root;
+            while(true) {
+                size_t lsz = sizeOf(ptr->lson);
+                if(k < lsz) ptr = ptr->lson;
+                else if(k == lsz) return ptr;
+                else { k -= lsz + 1; ptr = ptr->rson; }
+            }
+        }
+        
+        int height(node *p) {
+            if(p == nullptr) return 0;
+            return std::max(height(p->lson), height(p->rson)) + 1;
+        }
+    };
+
+}
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ * the two rotations of a treap, on any node type with parent, lson
+ * and rson. treap.hpp and sequence.hpp both rotate with them.
+ */
+#ifndef SJTU_TREAP_ROTATE_HPP
+#define SJTU_TREAP_ROTATE_HPP
+
+namespace sjtu {
+
+    /** do rotation and handle parent field, return pointer to new_top.
+     * attention: root node has no parent.
+     * parent field is horrible!
+     * N is any node with parent, lson and rson; the caller recomputes
+     * whatever p and then the new top keep about their subtrees. */
+    template<class N>
+    N *treap_rotate_right(N *p) {
+        N *nt = p->lson; // nt: new_top.
+        /// root node parent special case.
+        if(p->parent) {
+            if(p == p->parent->lson) p->parent->lson = nt;
+            else p->parent->rson = nt;
+        }
+        
+        nt->parent = p->parent; p->parent = nt;
+        p->lson = nt->rson;
+        if(p->lson) p->lson->parent = p;
+        nt->rson = p;
+        return nt;
+    }
+    template<class N>
+    N *treap_rotate_left(N *p) {
+        N *nt = p->rson;
+        
+        if(p->parent) {
+            if(p == p->parent->lson) p->parent->lson = nt;
+            else p->parent->rson = nt;
+        }
+        
+        nt->parent = p->parent; p->parent = nt;
+        p->rson = nt->lson;
+        if(p->rson) p->rson->parent = p;
+        nt->lson = p;
+        return nt;
+    }
+}
+
+#endif
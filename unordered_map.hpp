@@ -0,0 +1,491 @@
+/**
+ * implement a container like std::unordered_map with open addressing.
+ *
+ * slots are grouped by 16, and every slot has a control byte: the top bit
+ * marks an empty slot, otherwise the low 7 bits keep 7 bits of the hash.
+ * a lookup compares the 16 control bytes of a group with one SSE2
+ * instruction and only calls KeyEqual on the slots whose bits match.
+ *
+ * every group counts the elements that passed over it because it was
+ * full when they were inserted. a lookup stops at the first group whose
+ * count is zero, so erase simply empties the slot and decrements the
+ * counts on the way, and no tombstone is left behind.
+ *
+ * insert may rehash and invalidate all iterators, erase invalidates only
+ * the erased one.
+ */
+#ifndef SJTU_UNORDERED_MAP_HPP
+#define SJTU_UNORDERED_MAP_HPP
+
+// only for std::hash<T> and std::equal_to<T>
+#include <functional>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+    template<
+    class Key,
+    class T,
+    class Hash = std::hash<Key>,
+    class KeyEqual = std::equal_to<Key>,
+    class Allocator = std::allocator<pair<const Key, T>>
+    > class unordered_map {
+    public:
+        typedef pair<const Key, T> value_type;
+        typedef Allocator allocator_type;
+    private:
+        static const int groupWidth = 16;
+        static const unsigned char emptyCtrl = 0x80;
+
+        typedef typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type slot;
+        typedef std::allocator_traits<Allocator> alloc_traits;
+        typedef typename alloc_traits::template rebind_alloc<unsigned char> ctrl_allocator;
+        typedef typename alloc_traits::template rebind_alloc<slot> slot_allocator;
+        typedef typename alloc_traits::template rebind_alloc<size_t> count_allocator;
+
+        /// groupCnt is 0 or a power of 2, there are groupCnt * groupWidth slots.
+        unsigned char *ctrl;
+        slot *slots;
+        size_t *overflow;
+        size_t groupCnt;
+        size_t elemSz;
+        Hash hasher;
+        KeyEqual eq;
+        Allocator alloc;
+
+        /// bit i is set if the i-th control byte of the group equals b.
+        static unsigned matchByte(const unsigned char *group, unsigned char b) {
+#ifdef __SSE2__
+            __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+            return unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(char(b)))));
+#else
+            unsigned mask = 0;
+            for(int i = 0; i < groupWidth; ++i)
+                if(group[i] == b) mask |= 1u << i;
+            return mask;
+#endif
+        }
+        /// bit i is set if the i-th slot of the group is empty.
+        static unsigned matchEmpty(const unsigned char *group) {
+#ifdef __SSE2__
+            __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+            return unsigned(_mm_movemask_epi8(g));
+#else
+            unsigned mask = 0;
+            for(int i = 0; i < groupWidth; ++i)
+                if(group[i] & emptyCtrl) mask |= 1u << i;
+            return mask;
+#endif
+        }
+        /// index of the lowest set bit, mask must not be 0.
+        static int lowBit(unsigned mask) {
+#if defined(__GNUC__)
+            return __builtin_ctz(mask);
+#else
+            int i = 0;
+            while(!(mask & 1u)) { mask >>= 1; ++i; }
+            return i;
+#endif
+        }
+
+        /// std::hash of integers is the identity, so the bits are mixed first.
+        size_t hashOf(const Key &key) const {
+            size_t h = hasher(key) * static_cast<size_t>(0x9E3779B97F4A7C15ull);
+            return h ^ (h >> (sizeof(size_t) * 4));
+        }
+        static unsigned char tagOf(size_t h) { return static_cast<unsigned char>(h & 0x7F); }
+        /// the step-th group of the probe sequence, which visits every group once.
+        size_t probe(size_t h, size_t step) const {
+            return ((h >> 7) + step * (step + 1) / 2) & (groupCnt - 1);
+        }
+
+        value_type *valueAt(size_t i) { return reinterpret_cast<value_type *>(slots + i); }
+        const value_type *valueAt(size_t i) const { return reinterpret_cast<const value_type *>(slots + i); }
+
+        /// index of the slot holding key, or the number of slots.
+        size_t indexOf(const Key &key) const {
+            if(groupCnt == 0) return 0;
+            size_t h = hashOf(key);
+            unsigned char tag = tagOf(h);
+            for(size_t step = 0; step < groupCnt; ++step) {
+                size_t g = probe(h, step);
+                const unsigned char *group = ctrl + g * groupWidth;
+                for(unsigned mask = matchByte(group, tag); mask != 0; mask &= mask - 1) {
+                    size_t i = g * groupWidth + lowBit(mask);
+                    if(eq(valueAt(i)->first, key)) return i;
+                }
+                if(overflow[g] == 0) break;
+            }
+            return groupCnt * groupWidth;
+        }
+        /// take an empty slot for a key with hash h, which must not be present.
+        size_t claim(size_t h) {
+            for(size_t step = 0; ; ++step) {
+                size_t g = probe(h, step);
+                unsigned mask = matchEmpty(ctrl + g * groupWidth);
+                if(mask != 0) {
+                    size_t i = g * groupWidth + lowBit(mask);
+                    ctrl[i] = tagOf(h);
+                    return i;
+                }
+                ++overflow[g];
+            }
+        }
+
+        void allocateTable(size_t groups) {
+            groupCnt = groups;
+            ctrl_allocator ctrlAlloc(alloc);
+            slot_allocator slotAlloc(alloc);
+            count_allocator countAlloc(alloc);
+            ctrl = std::allocator_traits<ctrl_allocator>::allocate(ctrlAlloc, groups * groupWidth);
+            slots = std::allocator_traits<slot_allocator>::allocate(slotAlloc, groups * groupWidth);
+            overflow = std::allocator_traits<count_allocator>::allocate(countAlloc, groups);
+            memset(ctrl, emptyCtrl, groups * groupWidth);
+            memset(overflow, 0, groups * sizeof(size_t));
+        }
+        /// the elements must have been destroyed or moved.
+        void deallocateTable() {
+            if(groupCnt == 0) return;
+            ctrl_allocator ctrlAlloc(alloc);
+            slot_allocator slotAlloc(alloc);
+            count_allocator countAlloc(alloc);
+            std::allocator_traits<ctrl_allocator>::deallocate(ctrlAlloc, ctrl, groupCnt * groupWidth);
+            std::allocator_traits<slot_allocator>::deallocate(slotAlloc, slots, groupCnt * groupWidth);
+            std::allocator_traits<count_allocator>::deallocate(countAlloc, overflow, groupCnt);
+            ctrl = nullptr; slots = nullptr; overflow = nullptr;
+            groupCnt = 0;
+        }
+        /// move every element into a table of the given number of groups.
+        void rehash(size_t groups) {
+            unsigned char *oldCtrl = ctrl;
+            slot *oldSlots = slots;
+            size_t *oldOverflow = overflow;
+            size_t oldCnt = groupCnt;
+            allocateTable(groups);
+            for(size_t i = 0; i < oldCnt * groupWidth; ++i) {
+                if(oldCtrl[i] & emptyCtrl) continue;
+                value_type *p = reinterpret_cast<value_type *>(oldSlots + i);
+                new (valueAt(claim(hashOf(p->first)))) value_type(std::move(*p));
+                p->~value_type();
+            }
+            if(oldCnt != 0) {
+                ctrl_allocator ctrlAlloc(alloc);
+                slot_allocator slotAlloc(alloc);
+                count_allocator countAlloc(alloc);
+                std::allocator_traits<ctrl_allocator>::deallocate(ctrlAlloc, oldCtrl, oldCnt * groupWidth);
+                std::allocator_traits<slot_allocator>::deallocate(slotAlloc, oldSlots, oldCnt * groupWidth);
+                std::allocator_traits<count_allocator>::deallocate(countAlloc, oldOverflow, oldCnt);
+            }
+        }
+        /// keep the load factor at most 7/8.
+        void reserveOne() {
+            if(groupCnt == 0) rehash(1);
+            else if((elemSz + 1) * 8 > groupCnt * groupWidth * 7) rehash(groupCnt * 2);
+        }
+        void destroyAll() {
+            for(size_t i = 0; i < groupCnt * groupWidth; ++i)
+                if(!(ctrl[i] & emptyCtrl)) valueAt(i)->~value_type();
+        }
+        void copyFrom(const unordered_map &other) {
+            if(other.elemSz == 0) return;
+            allocateTable(other.groupCnt);
+            memcpy(ctrl, other.ctrl, groupCnt * groupWidth);
+            memcpy(overflow, other.overflow, groupCnt * sizeof(size_t));
+            for(size_t i = 0; i < groupCnt * groupWidth; ++i)
+                if(!(ctrl[i] & emptyCtrl)) new (valueAt(i)) value_type(*other.valueAt(i));
+            elemSz = other.elemSz;
+        }
+        void swapTable(unordered_map &other) {
+            std::swap(ctrl, other.ctrl);
+            std::swap(slots, other.slots);
+            std::swap(overflow, other.overflow);
+            std::swap(groupCnt, other.groupCnt);
+            std::swap(elemSz, other.elemSz);
+            using std::swap;
+            swap(hasher, other.hasher);
+            swap(eq, other.eq);
+        }
+        /// the first full slot from i on, or the number of slots.
+        size_t nextFull(size_t i) const {
+            while(i < groupCnt * groupWidth && (ctrl[i] & emptyCtrl)) ++i;
+            return i;
+        }
+    public:
+        /**
+         * see BidirectionalIterator at CppReference for help.
+         * the order of elements is unspecified.
+         *
+         * if there is anything wrong throw invalid_iterator.
+         *     like it = map.begin(); --it;
+         *       or it = map.end(); ++end();
+         */
+        class const_iterator;
+        class iterator {
+            friend const_iterator;
+            friend unordered_map;
+        private:
+            size_t pos;
+            unordered_map *owner;
+
+            iterator(size_t p, unordered_map *o): pos(p), owner(o) {}
+        public:
+            iterator(): pos(0), owner(nullptr) {}
+            iterator(const iterator &other): pos(other.pos), owner(other.owner) {}
+
+            iterator operator++(int) {
+                iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            iterator & operator++() {
+                if(owner == nullptr || pos >= owner->groupCnt * groupWidth) throw invalid_iterator();
+                pos = owner->nextFull(pos + 1);
+                return *this;
+            }
+            iterator operator--(int) {
+                iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+            iterator & operator--() {
+                if(owner == nullptr) throw invalid_iterator();
+                size_t i = pos;
+                while(i > 0 && (owner->ctrl[i - 1] & emptyCtrl)) --i;
+                if(i == 0) throw invalid_iterator();
+                pos = i - 1;
+                return *this;
+            }
+            value_type & operator*() const {
+                if(owner == nullptr || pos >= owner->groupCnt * groupWidth) throw index_out_of_bound();
+                return *owner->valueAt(pos);
+            }
+            value_type* operator->() const {
+                if(owner == nullptr || pos >= owner->groupCnt * groupWidth) throw invalid_iterator();
+                return owner->valueAt(pos);
+            }
+            bool operator==(const iterator &rhs) const { return pos == rhs.pos && owner == rhs.owner; }
+            bool operator==(const const_iterator &rhs) const { return pos == rhs.pos && owner == rhs.owner; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        };
+        class const_iterator {
+            friend iterator;
+            friend unordered_map;
+        private:
+            size_t pos;
+            const unordered_map *owner;
+
+            const_iterator(size_t p, const unordered_map *o): pos(p), owner(o) {}
+        public:
+            const_iterator(): pos(0), owner(nullptr) {}
+            const_iterator(const const_iterator &other): pos(other.pos), owner(other.owner) {}
+            const_iterator(const iterator &other): pos(other.pos), owner(other.owner) {}
+
+            const_iterator operator++(int) {
+                const_iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+            const_iterator & operator++() {
+                if(owner == nullptr || pos >= owner->groupCnt * groupWidth) throw invalid_iterator();
+                pos = owner->nextFull(pos + 1);
+                return *this;
+            }
+            const_iterator operator--(int) {
+                const_iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+            const_iterator & operator--() {
+                if(owner == nullptr) throw invalid_iterator();
+                size_t i = pos;
+                while(i > 0 && (owner->ctrl[i - 1] & emptyCtrl)) --i;
+                if(i == 0) throw invalid_iterator();
+                pos = i - 1;
+                return *this;
+            }
+            const value_type & operator*() const {
+                if(owner == nullptr || pos >= owner->groupCnt * groupWidth) throw index_out_of_bound();
+                return *owner->valueAt(pos);
+            }
+            const value_type* operator->() const {
+                if(owner == nullptr || pos >= owner->groupCnt * groupWidth) throw invalid_iterator();
+                return owner->valueAt(pos);
+            }
+            bool operator==(const iterator &rhs) const { return pos == rhs.pos && owner == rhs.owner; }
+            bool operator==(const const_iterator &rhs) const { return pos == rhs.pos && owner == rhs.owner; }
+            bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+            bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+        };
+
+        unordered_map(): unordered_map(Hash()) {}
+        explicit unordered_map(const Allocator &a): unordered_map(Hash(), KeyEqual(), a) {}
+        explicit unordered_map(const Hash &h, const KeyEqual &e = KeyEqual(), const Allocator &a = Allocator()):
+        ctrl(nullptr), slots(nullptr), overflow(nullptr), groupCnt(0), elemSz(0), hasher(h), eq(e), alloc(a) {}
+        unordered_map(const unordered_map &other):
+        unordered_map(other.hasher, other.eq, alloc_traits::select_on_container_copy_construction(other.alloc)) {
+            copyFrom(other);
+        }
+        /// other is left empty.
+        unordered_map(unordered_map &&other): unordered_map(other.hasher, other.eq, other.alloc) { swap(other); }
+        unordered_map & operator=(const unordered_map &other) {
+            if(&other == this) return *this;
+            clear();
+            deallocateTable();
+            if(alloc_traits::propagate_on_container_copy_assignment::value) alloc = other.alloc;
+            hasher = other.hasher;
+            eq = other.eq;
+            copyFrom(other);
+            return *this;
+        }
+        unordered_map & operator=(unordered_map &&other) {
+            if(&other == this) return *this;
+            clear();
+            if(alloc_traits::propagate_on_container_move_assignment::value || alloc == other.alloc) {
+                deallocateTable();
+                swapTable(other);
+                if(alloc_traits::propagate_on_container_move_assignment::value) {
+                    using std::swap;
+                    swap(alloc, other.alloc);
+                }
+            }
+            else {
+                deallocateTable();
+                hasher = other.hasher;
+                eq = other.eq;
+                copyFrom(other);
+                other.clear();
+            }
+            return *this;
+        }
+        ~unordered_map() {
+            clear();
+            deallocateTable();
+        }
+        /**
+         * exchanges the contents with other.
+         * allocators are swapped only if the allocator asks for it.
+         */
+        void swap(unordered_map &other) {
+            swapTable(other);
+            if(alloc_traits::propagate_on_container_swap::value) {
+                using std::swap;
+                swap(alloc, other.alloc);
+            }
+        }
+        allocator_type get_allocator() const { return alloc; }
+
+        /**
+         * access specified element with bounds checking
+         * Returns a reference to the mapped value of the element with key equivalent to key.
+         * If no such element exists, an exception of type `index_out_of_bound'
+         */
+        T & at(const Key &key) {
+            size_t i = indexOf(key);
+            if(i == groupCnt * groupWidth) throw index_out_of_bound();
+            return valueAt(i)->second;
+        }
+        const T & at(const Key &key) const {
+            size_t i = indexOf(key);
+            if(i == groupCnt * groupWidth) throw index_out_of_bound();
+            return valueAt(i)->second;
+        }
+        /**
+         * access specified element
+         * Returns a reference to the value that is mapped to a key equivalent to key,
+         *   performing an insertion if such key does not already exist.
+         */
+        T & operator[](const Key &key) {
+            size_t i = indexOf(key);
+            if(i != groupCnt * groupWidth) return valueAt(i)->second;
+            return insert(value_type(key, T())).first->second;
+        }
+        /**
+         * behave like at() throw index_out_of_bound if such key does not exist.
+         */
+        const T & operator[](const Key &key) const { return at(key); }
+
+        iterator begin() { return iterator(nextFull(0), this); }
+        const_iterator cbegin() const { return const_iterator(nextFull(0), this); }
+        iterator end() { return iterator(groupCnt * groupWidth, this); }
+        const_iterator cend() const { return const_iterator(groupCnt * groupWidth, this); }
+
+        bool empty() const { return elemSz == 0; }
+        size_t size() const { return elemSz; }
+        /// the table is kept for later inserts.
+        void clear() {
+            if(elemSz == 0) return;
+            destroyAll();
+            memset(ctrl, emptyCtrl, groupCnt * groupWidth);
+            memset(overflow, 0, groupCnt * sizeof(size_t));
+            elemSz = 0;
+        }
+        /// make room for n elements without rehashing.
+        void reserve(size_t n) {
+            size_t groups = groupCnt == 0 ? 1 : groupCnt;
+            while(n * 8 > groups * groupWidth * 7) groups *= 2;
+            if(groups != groupCnt) rehash(groups);
+        }
+        /**
+         * insert an element.
+         * return a pair, the first of the pair is
+         *   the iterator to the new element (or the element that prevented the insertion),
+         *   the second one is true if insert successfully, or false.
+         */
+        pair<iterator, bool> insert(const value_type &value) {
+            size_t i = indexOf(value.first);
+            if(i != groupCnt * groupWidth) return pair<iterator, bool>(iterator(i, this), false);
+            reserveOne();
+            i = claim(hashOf(value.first));
+            new (valueAt(i)) value_type(value);
+            ++elemSz;
+            return pair<iterator, bool>(iterator(i, this), true);
+        }
+        /**
+         * erase the element at pos.
+         *
+         * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
+         *
+         * the groups passed over on the way to pos forget one overflow.
+         */
+        void erase(iterator pos) {
+            if(pos.owner != this) throw invalid_iterator();
+            if(pos.pos >= groupCnt * groupWidth || (ctrl[pos.pos] & emptyCtrl)) throw index_out_of_bound();
+            size_t h = hashOf(valueAt(pos.pos)->first);
+            size_t home = pos.pos / groupWidth;
+            for(size_t step = 0; ; ++step) {
+                size_t g = probe(h, step);
+                if(g == home) break;
+                --overflow[g];
+            }
+            valueAt(pos.pos)->~value_type();
+            ctrl[pos.pos] = emptyCtrl;
+            --elemSz;
+        }
+        /**
+         * Returns the number of elements with key
+         *   that compares equivalent to the specified argument,
+         *   which is either 1 or 0
+         *     since this container does not allow duplicates.
+         */
+        size_t count(const Key &key) const { return indexOf(key) == groupCnt * groupWidth ? 0 : 1; }
+        /**
+         * Finds an element with key equivalent to key.
+         *   If no such element is found, past-the-end (see end()) iterator is returned.
+         */
+        iterator find(const Key &key) { return iterator(indexOf(key), this); }
+        const_iterator find(const Key &key) const { return const_iterator(indexOf(key), this); }
+    };
+}
+
+#endif
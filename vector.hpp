@@ -5,29 +5,157 @@
 
 #include <climits>
 #include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 /* += -= 的返回类型应不应该是引用呢？ */
 namespace sjtu {
+/**
+ * whether an object of T can be moved to another address by memcpy,
+ * leaving the source as raw memory.
+ * specialize it for your own types which don't hold pointers into themselves.
+ */
+template<typename T>
+struct is_relocatable : std::integral_constant<bool, std::is_trivially_copyable<T>::value> {};
+
 /**
  * a data container like std::vector
  * store data in a successive memory and support random access.
+ * the storage comes from Allocator, elements are constructed in place.
  */
-template<typename T>
+template<typename T, class Allocator = std::allocator<T>>
 class vector {
+public:
+	typedef Allocator allocator_type;
 protected:
+	typedef std::allocator_traits<Allocator> alloc_traits;
+
 	T *head;
 	size_t logicLen, allocLen;
-	void doubleSpace() {
-		T *tmp = head;
-		allocLen *= 2;
-		head = (T *)malloc(allocLen * sizeof(T));
-		T *curPtr = &head[0];
-		for(int i = 0; i < logicLen; ++i){
-			new (curPtr++) T(tmp[i]);
-			tmp[i].~T();
+	Allocator alloc;
+	/* Move n objects from src to the raw memory dst, src becomes raw memory.
+	 * Relocatable types are moved by memcpy, others by their move constructor. */
+	static void relocate(T *dst, T *src, size_t n, std::true_type) {
+		if(n != 0)
+			memcpy((void *)dst, (const void *)src, n * sizeof(T));
+	}
+	static void relocate(T *dst, T *src, size_t n, std::false_type) {
+		for(size_t i = 0; i < n; ++i){
+			new (dst + i) T(std::move_if_noexcept(src[i]));
+			src[i].~T();
 		}
-		free(tmp);
 	}
+	/* Copy construct n objects from src into the raw memory dst. */
+	static void copyConstruct(T *dst, const T *src, size_t n, std::true_type) {
+		if(n != 0)
+			memcpy((void *)dst, (const void *)src, n * sizeof(T));
+	}
+	static void copyConstruct(T *dst, const T *src, size_t n, std::false_type) {
+		for(size_t i = 0; i < n; ++i)
+			new (dst + i) T(src[i]);
+	}
+	/* Move the tail [ind, logicLen) back by n, the capacity must be enough.
+	 * For relocatable types the gap [ind, ind + n) becomes raw memory,
+	 * otherwise slots of the gap below logicLen still hold moved-from objects. */
+	void openGap(size_t ind, size_t n, std::true_type) {
+		memmove((void *)(head + ind + n), (const void *)(head + ind), (logicLen - ind) * sizeof(T));
+	}
+	void openGap(size_t ind, size_t n, std::false_type) {
+		for(size_t cur = logicLen; cur-- > ind; ){
+			if(cur + n >= logicLen)
+				new (&head[cur + n]) T(std::move(head[cur]));
+			else
+				head[cur + n] = std::move(head[cur]);
+		}
+	}
+	/* Put value into slot i of a gap made by openGap, before logicLen is updated. */
+	template<typename U>
+	void fillGap(size_t i, U &&value, std::true_type) {
+		new (&head[i]) T(std::forward<U>(value));
+	}
+	template<typename U>
+	void fillGap(size_t i, U &&value, std::false_type) {
+		if(i >= logicLen)
+			new (&head[i]) T(std::forward<U>(value));
+		else
+			head[i] = std::forward<U>(value);
+	}
+	/* Destroy [ind, ind + n) and move the tail forward to fill the hole. */
+	void closeGap(size_t ind, size_t n, std::true_type) {
+		for(size_t i = ind; i < ind + n; ++i)
+			head[i].~T();
+		memmove((void *)(head + ind), (const void *)(head + ind + n), (logicLen - ind - n) * sizeof(T));
+	}
+	void closeGap(size_t ind, size_t n, std::false_type) {
+		for(size_t i = ind + n; i < logicLen; ++i)
+			head[i - n] = std::move(head[i]);
+		for(size_t i = logicLen - n; i < logicLen; ++i)
+			head[i].~T();
+	}
+	size_t grownLen() const { return allocLen == 0 ? 1 : allocLen * 2; }
+	/* An empty buffer is never allocated, so that empty vectors cost no memory. */
+	T *allocate(size_t n) {
+		return n == 0 ? nullptr : alloc_traits::allocate(alloc, n);
+	}
+	void deallocate(T *p, size_t n) {
+		if(p != nullptr)
+			alloc_traits::deallocate(alloc, p, n);
+	}
+	void reallocate(size_t newLen) {
+		T *tmp = head;
+		head = allocate(newLen);
+		relocate(head, tmp, logicLen, is_relocatable<T>());
+		deallocate(tmp, allocLen);
+		allocLen = newLen;
+	}
+	/* Release the storage and take over other's, the allocator is untouched. */
+	void steal(vector &other) {
+		clear();
+		deallocate(head, allocLen);
+		head = other.head;
+		logicLen = other.logicLen;
+		allocLen = other.allocLen;
+		other.head = nullptr;
+		other.logicLen = other.allocLen = 0;
+	}
+	void doubleSpace() { reallocate(grownLen()); }
+	/* Make sure n more elements fit, with at most one reallocation. */
+	void reserveMore(size_t n) {
+		if(logicLen + n <= allocLen)
+			return;
+		size_t newLen = grownLen();
+		reallocate(newLen < logicLen + n ? logicLen + n : newLen);
+	}
+	/* Insert [first, last) at ind: one reallocation and one shift of the tail.
+	 * A single pass range is buffered first since its length is unknown. */
+	template<typename InputIt>
+	void insertRange(size_t ind, InputIt first, InputIt last, std::input_iterator_tag) {
+		vector buf(alloc);
+		for(; first != last; ++first)
+			buf.emplace_back(*first);
+		insertRange(ind, std::make_move_iterator(buf.head), std::make_move_iterator(buf.head + buf.logicLen),
+		            std::forward_iterator_tag());
+	}
+	template<typename ForwardIt>
+	void insertRange(size_t ind, ForwardIt first, ForwardIt last, std::forward_iterator_tag) {
+		size_t n = std::distance(first, last);
+		if(n == 0)
+			return;
+		reserveMore(n);
+		openGap(ind, n, is_relocatable<T>());
+		for(size_t i = ind; i < ind + n; ++i, ++first)
+			fillGap(i, *first, is_relocatable<T>());
+		logicLen += n;
+	}
+	template<typename InputIt>
+	using iteratorTag = typename std::iterator_traits<InputIt>::iterator_category;
+	template<typename InputIt>
+	using notIntegral = typename std::enable_if<!std::is_integral<InputIt>::value, int>::type;
 public:
 	/**
 	 * TODO
@@ -49,13 +177,21 @@ public:
 		 *   just add whatever you want.
 		 */
 
-		 /* An iterator is implemented as a pointer to T. */
+		 /* An iterator is implemented as a pointer to T.
+		  * headAddress is the vector it belongs to, since the buffer may be
+		  * null or reallocated. */
 		T *ptr;
-		const T *headAddress;
+		const vector *headAddress;
 	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef int difference_type;
+		typedef T* pointer;
+		typedef T& reference;
+
 		/* The iterator is constructed by pointer, which takes the advantage of
 		 * pointer arithmetic. */
-		iterator(T *p = nullptr, const T *headPtr = nullptr): ptr(p), headAddress(headPtr) {}
+		iterator(T *p = nullptr, const vector *headPtr = nullptr): ptr(p), headAddress(headPtr) {}
 
 		iterator(const iterator &other):ptr(other.ptr), headAddress(other.headAddress){}
 		/**
@@ -154,12 +290,18 @@ public:
 		friend iterator;
 	private:
 		const T *const_ptr;
-		const T *headAddress;
+		const vector *headAddress;
 
 	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef int difference_type;
+		typedef const T* pointer;
+		typedef const T& reference;
+
 		/* The iterator is constructed by pointer, which takes the advantage of
 		 * pointer arithmetic. */
-		const_iterator(const T *p = nullptr, const T *headPtr = nullptr): const_ptr(p), headAddress(headPtr) {}
+		const_iterator(const T *p = nullptr, const vector *headPtr = nullptr): const_ptr(p), headAddress(headPtr) {}
 		const_iterator(const const_iterator &other):const_ptr(other.const_ptr), headAddress(other.headAddress){}
 		/**
 		 * return a new iterator which pointer n-next elements
@@ -251,24 +393,34 @@ public:
 	 * TODO Constructs
 	 * Atleast three: default constructor, copy constructor and a constructor for std::vector
 	 */
-	vector(size_t size = 10) {
-		head = (T *)malloc(size * sizeof(T));
+	/* Nothing is allocated until the first element comes. */
+	vector(): head(nullptr), logicLen(0), allocLen(0), alloc() {}
+	explicit vector(const Allocator &a): head(nullptr), logicLen(0), allocLen(0), alloc(a) {}
+	/* Reserve space for size elements. */
+	vector(size_t size, const Allocator &a = Allocator()): alloc(a) {
+		head = allocate(size);
 		logicLen = 0;
 		allocLen = size;
 	}
-	vector(const vector &other) {
-		head = (T *)malloc(other.allocLen * sizeof(T));
-		for(int i = 0; i < other.logicLen; ++i)
-			head[i] = other.head[i];
-		allocLen = other.allocLen;
+	vector(const vector &other):
+	alloc(alloc_traits::select_on_container_copy_construction(other.alloc)) {
+		head = allocate(other.logicLen);
+		copyConstruct(head, other.head, other.logicLen, std::is_trivially_copyable<T>());
+		allocLen = other.logicLen;
 		logicLen = other.logicLen;
 	}
+	/* The moved-from vector is left empty with no storage. */
+	vector(vector &&other):
+	head(other.head), logicLen(other.logicLen), allocLen(other.allocLen), alloc(std::move(other.alloc)) {
+		other.head = nullptr;
+		other.logicLen = other.allocLen = 0;
+	}
 	/**
 	 * TODO Destructor
 	 */
 	~vector() {
 		clear();
-		free(head);
+		deallocate(head, allocLen);
 	}
 	/**
 	 * TODO Assignment operator
@@ -279,14 +431,59 @@ public:
 			return *this;
 
 		clear();
-		free(head);
-		head = (T *)malloc(other.allocLen * sizeof(T));
-		for(int i = 0; i < other.logicLen; ++i)
-			head[i] = other.head[i];
-		allocLen = other.allocLen;
+		/* Memory from the old allocator must go back to it before switching. */
+		if(alloc_traits::propagate_on_container_copy_assignment::value && alloc != other.alloc){
+			deallocate(head, allocLen);
+			head = nullptr;
+			allocLen = 0;
+		}
+		if(alloc_traits::propagate_on_container_copy_assignment::value)
+			alloc = other.alloc;
+		/* Reuse the buffer if it is large enough. */
+		if(allocLen < other.logicLen){
+			deallocate(head, allocLen);
+			head = allocate(other.logicLen);
+			allocLen = other.logicLen;
+		}
+		copyConstruct(head, other.head, other.logicLen, std::is_trivially_copyable<T>());
 		logicLen = other.logicLen;
 		return *this;
 	}
+	vector &operator=(vector &&other) {
+		if(this == &other)
+			return *this;
+
+		if(alloc_traits::propagate_on_container_move_assignment::value){
+			steal(other);
+			alloc = std::move(other.alloc);
+		}
+		else if(alloc == other.alloc)
+			steal(other);
+		else{
+			/* The buffer of other can't be freed by our allocator,
+			 * move the elements one by one instead. */
+			clear();
+			reserve(other.logicLen);
+			relocate(head, other.head, other.logicLen, is_relocatable<T>());
+			logicLen = other.logicLen;
+			other.logicLen = 0;
+		}
+		return *this;
+	}
+	/**
+	 * exchanges the contents with other.
+	 * allocators are swapped only if the allocator asks for it.
+	 */
+	void swap(vector &other) {
+		std::swap(head, other.head);
+		std::swap(logicLen, other.logicLen);
+		std::swap(allocLen, other.allocLen);
+		if(alloc_traits::propagate_on_container_swap::value){
+			using std::swap;
+			swap(alloc, other.alloc);
+		}
+	}
+	allocator_type get_allocator() const { return alloc; }
 	/**
 	 * assigns specified element with bounds checking
 	 * throw index_out_of_bound if pos is not in [0, size)
@@ -341,16 +538,21 @@ public:
 
 		return head[logicLen - 1];
 	}
+	/**
+	 * direct access to the underlying array, without any checking.
+	 */
+	T * data() { return head; }
+	const T * data() const { return head; }
 	/**
 	 * returns an iterator to the beginning.
 	 */
-	iterator begin() { return iterator(&head[0], head); }
-	const_iterator cbegin() const { return const_iterator(&head[0], head); }
+	iterator begin() { return iterator(head, this); }
+	const_iterator cbegin() const { return const_iterator(head, this); }
 	/**
 	 * returns an iterator to the end.
 	 */
-	iterator end() { return iterator(&head[logicLen], head); }
-	const_iterator cend() const { return const_iterator(&head[logicLen], head); }
+	iterator end() { return iterator(head + logicLen, this); }
+	const_iterator cend() const { return const_iterator(head + logicLen, this); }
 	/**
 	 * checks whether the container is empty
 	 */
@@ -363,6 +565,39 @@ public:
 	 * returns the number of elements that can be held in currently allocated storage.
 	 */
 	size_t capacity() const { return allocLen; }
+	/**
+	 * increases the capacity to at least n, with at most one reallocation.
+	 */
+	void reserve(size_t n) {
+		if(n > allocLen)
+			reallocate(n);
+	}
+	/**
+	 * resizes the container to contain n elements.
+	 * new elements are value-initialized, or copies of value.
+	 */
+	void resize(size_t n) {
+		if(n <= logicLen){
+			erase(n, logicLen);
+			return;
+		}
+		reserve(n);
+		for(; logicLen < n; ++logicLen)
+			new (&head[logicLen]) T();
+	}
+	void resize(size_t n, const T &value) {
+		if(n <= logicLen)
+			erase(n, logicLen);
+		else
+			insert(logicLen, n - logicLen, value);
+	}
+	/**
+	 * gives the unused capacity back, an empty vector frees its buffer.
+	 */
+	void shrink_to_fit() {
+		if(allocLen != logicLen)
+			reallocate(logicLen);
+	}
 	/**
 	 * clears the contents
 	 */
@@ -411,29 +646,128 @@ public:
 	 * throw index_out_of_bound if ind > size (in this situation ind can be size because after inserting the size will increase 1.)
 	 */
 	iterator insert(const size_t &ind, const T &value) {
-		/** Because end() is given by one hop behind the last element. */
-		if(allocLen <= logicLen + 1)
-			doubleSpace();
+		return emplace(ind, value);
+	}
+	iterator insert(iterator pos, T &&value) {
+		int posIdx = pos - begin();
+		if(posIdx < 0 || posIdx > logicLen)
+			throw index_out_of_bound();
 
+		return emplace(posIdx, std::move(value));
+	}
+	iterator insert(const size_t &ind, T &&value) {
+		return emplace(ind, std::move(value));
+	}
+	/**
+	 * constructs an element in place before pos.
+	 * returns an iterator pointing to the new element.
+	 */
+	template<typename... Args>
+	iterator emplace(iterator pos, Args&&... args) {
+		int posIdx = pos - begin();
+		if(posIdx < 0 || posIdx > logicLen)
+			throw index_out_of_bound();
+
+		return emplace(posIdx, std::forward<Args>(args)...);
+	}
+	/**
+	 * constructs an element in place at index ind.
+	 * throw index_out_of_bound if ind > size
+	 */
+	template<typename... Args>
+	iterator emplace(const size_t &ind, Args&&... args) {
 		/** size_t type ensures that ind cannot be negative. */
 		if(ind > logicLen)
 			throw index_out_of_bound();
 
+		if(ind == logicLen){
+			emplace_back(std::forward<Args>(args)...);
+			return begin() + ind;
+		}
+
+		/* args may refer to an element of this vector, build the value
+		 * before anything is moved. */
+		T value(std::forward<Args>(args)...);
+		if(allocLen == logicLen)
+			doubleSpace();
 
 		// 确保为未构造对象的内存构造对象。
-		T * endPtr = &head[logicLen];
-		new (endPtr) T(value);
-		size_t cur = logicLen;
-		while(cur != ind){
-			head[cur] = head[cur-1];
-			--cur;
-		}
+		openGap(ind, 1, is_relocatable<T>());
+		fillGap(ind, std::move(value), is_relocatable<T>());
+		++logicLen;
+
+		return begin() + ind;
+	}
+	/**
+	 * inserts n copies of value before pos, or at index ind.
+	 * returns an iterator pointing to the first inserted value.
+	 */
+	iterator insert(iterator pos, size_t n, const T &value) {
+		int posIdx = pos - begin();
+		if(posIdx < 0 || posIdx > logicLen)
+			throw index_out_of_bound();
 
-		head[ind] = value;
-        ++logicLen;
+		return insert(size_t(posIdx), n, value);
+	}
+	iterator insert(const size_t &ind, size_t n, const T &value) {
+		if(ind > logicLen)
+			throw index_out_of_bound();
+
+		if(n == 0)
+			return begin() + ind;
+
+		/* value may be an element of this vector. */
+		T tmp(value);
+		reserveMore(n);
+		openGap(ind, n, is_relocatable<T>());
+		for(size_t i = ind; i < ind + n; ++i)
+			fillGap(i, tmp, is_relocatable<T>());
+		logicLen += n;
 
 		return begin() + ind;
 	}
+	/**
+	 * inserts [first, last) before pos, or at index ind.
+	 * reallocates at most once and shifts the tail only once.
+	 * first and last must not point into this vector.
+	 * returns an iterator pointing to the first inserted value.
+	 */
+	template<typename InputIt, notIntegral<InputIt> = 0>
+	iterator insert(iterator pos, InputIt first, InputIt last) {
+		int posIdx = pos - begin();
+		if(posIdx < 0 || posIdx > logicLen)
+			throw index_out_of_bound();
+
+		return insert(size_t(posIdx), first, last);
+	}
+	template<typename InputIt, notIntegral<InputIt> = 0>
+	iterator insert(const size_t &ind, InputIt first, InputIt last) {
+		if(ind > logicLen)
+			throw index_out_of_bound();
+
+		insertRange(ind, first, last, iteratorTag<InputIt>());
+		return begin() + ind;
+	}
+	/**
+	 * adds [first, last) to the end.
+	 */
+	template<typename InputIt, notIntegral<InputIt> = 0>
+	void append(InputIt first, InputIt last) {
+		insertRange(logicLen, first, last, iteratorTag<InputIt>());
+	}
+	/**
+	 * replaces the contents with [first, last), or with n copies of value.
+	 */
+	template<typename InputIt, notIntegral<InputIt> = 0>
+	void assign(InputIt first, InputIt last) {
+		clear();
+		insertRange(0, first, last, iteratorTag<InputIt>());
+	}
+	void assign(size_t n, const T &value) {
+		T tmp(value);
+		clear();
+		insert(size_t(0), n, tmp);
+	}
 	/**
 	 * removes the element at pos.
 	 * return an iterator pointing to the following element.
@@ -471,22 +805,62 @@ public:
 		if(ind >= logicLen)
 			throw index_out_of_bound();
 
-		for(int i = ind + 1; i < logicLen; ++i)
-			head[i-1] = head[i];
-
-		head[logicLen-1].~T();
+		closeGap(ind, 1, is_relocatable<T>());
 		--logicLen;
 
 		return begin() + ind;
 	}
+	/**
+	 * removes the elements in [first, last), or with index in [first, last).
+	 * return an iterator pointing to the element following the removed ones.
+	 */
+	iterator erase(iterator first, iterator last) {
+		int firstIdx = first - begin(), lastIdx = last - begin();
+		if(firstIdx < 0 || firstIdx > lastIdx || lastIdx > logicLen)
+			throw index_out_of_bound();
+
+		return erase(size_t(firstIdx), size_t(lastIdx));
+	}
+	iterator erase(const size_t &first, const size_t &last) {
+		if(first > last || last > logicLen)
+			throw index_out_of_bound();
+
+		if(first != last){
+			closeGap(first, last - first, is_relocatable<T>());
+			logicLen -= last - first;
+		}
+		return begin() + first;
+	}
 	/**
 	 * adds an element to the end.
 	 */
 	void push_back(const T &value) {
-		if(allocLen <= logicLen + 1)
-			doubleSpace();
+		emplace_back(value);
+	}
+	void push_back(T &&value) {
+		emplace_back(std::move(value));
+	}
+	/**
+	 * constructs an element in place at the end.
+	 * returns a reference to the new element.
+	 */
+	template<typename... Args>
+	T & emplace_back(Args&&... args) {
+		if(logicLen == allocLen){
+			/* Construct into the new buffer before relocating, since args
+			 * may refer to an element of this vector. */
+			size_t newLen = grownLen();
+			T *tmp = allocate(newLen);
+			new (&tmp[logicLen]) T(std::forward<Args>(args)...);
+			relocate(tmp, head, logicLen, is_relocatable<T>());
+			deallocate(head, allocLen);
+			head = tmp;
+			allocLen = newLen;
+		}
+		else
+			new (&head[logicLen]) T(std::forward<Args>(args)...);
 
-		insert(end(), value);
+		return head[logicLen++];
 	}
 	/**
 	 * remove the last element from the end.